@@ -0,0 +1,182 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <array>
+#include <cstdint>
+
+#include "Field.h"
+#include "Figure.h"
+
+// Set of fields packed into a 64 bit word, bit number * 8 + letter stands for
+// one field (a1 = 0, h1 = 7, a8 = 56).
+using Bitboard = uint64_t;
+
+namespace bitboard {
+
+constexpr size_t NumberOfSquares = 64;
+
+constexpr Bitboard FileA = 0x0101010101010101ULL;
+constexpr Bitboard FileH = FileA << 7;
+constexpr Bitboard Rank1 = 0xFFULL;
+constexpr Bitboard Rank4 = Rank1 << (3 * 8);
+constexpr Bitboard Rank5 = Rank1 << (4 * 8);
+constexpr Bitboard Rank8 = Rank1 << (7 * 8);
+
+enum Direction {NORTH, EAST, NORTH_EAST, NORTH_WEST, SOUTH, WEST, SOUTH_WEST, SOUTH_EAST, LAST_DIRECTION};
+
+// Moves every field of the set by the given number of squares, positive
+// towards the eighth rank. Callers mask out fields crossing the board edge.
+template<int Offset>
+constexpr Bitboard shift(Bitboard bb) {
+  return Offset > 0 ? bb << Offset : bb >> -Offset;
+}
+
+inline int toSquare(Field field) {
+  return field.number * 8 + field.letter;
+}
+
+inline Field toField(int square) {
+  Field field;
+  field.letter = static_cast<Field::Letter>(square & 7);
+  field.number = static_cast<Field::Number>(square >> 3);
+  return field;
+}
+
+constexpr Bitboard squareBB(int square) {
+  return 1ULL << square;
+}
+
+inline Bitboard fieldBB(Field field) {
+  return squareBB(toSquare(field));
+}
+
+inline int lsb(Bitboard bb) {
+  return __builtin_ctzll(bb);
+}
+
+inline int msb(Bitboard bb) {
+  return 63 - __builtin_clzll(bb);
+}
+
+inline int popLsb(Bitboard& bb) {
+  const int square = lsb(bb);
+  bb &= bb - 1;
+  return square;
+}
+
+inline bool moreThanOne(Bitboard bb) {
+  return (bb & (bb - 1)) != 0;
+}
+
+namespace detail {
+
+struct Step {
+  int letter;
+  int number;
+};
+
+constexpr Step DirectionSteps[LAST_DIRECTION] = {
+  {0, 1}, {1, 0}, {1, 1}, {-1, 1}, {0, -1}, {-1, 0}, {-1, -1}, {1, -1}
+};
+
+constexpr Step KnightSteps[8] = {
+  {1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}
+};
+
+constexpr Bitboard step(int square, Step s) {
+  const int letter = (square & 7) + s.letter;
+  const int number = (square >> 3) + s.number;
+  if (letter < 0 || letter > 7 || number < 0 || number > 7) {
+    return 0;
+  }
+  return squareBB(number * 8 + letter);
+}
+
+constexpr std::array<Bitboard, NumberOfSquares> createKnightAttacks() {
+  std::array<Bitboard, NumberOfSquares> table{};
+  for (int square = 0; square < 64; ++square) {
+    for (const Step& s: KnightSteps) {
+      table[square] |= step(square, s);
+    }
+  }
+  return table;
+}
+
+constexpr std::array<Bitboard, NumberOfSquares> createKingAttacks() {
+  std::array<Bitboard, NumberOfSquares> table{};
+  for (int square = 0; square < 64; ++square) {
+    for (const Step& s: DirectionSteps) {
+      table[square] |= step(square, s);
+    }
+  }
+  return table;
+}
+
+constexpr std::array<std::array<Bitboard, NumberOfSquares>, 2> createPawnAttacks() {
+  std::array<std::array<Bitboard, NumberOfSquares>, 2> table{};
+  for (int square = 0; square < 64; ++square) {
+    table[Figure::WHITE][square] = step(square, {-1, 1}) | step(square, {1, 1});
+    table[Figure::BLACK][square] = step(square, {-1, -1}) | step(square, {1, -1});
+  }
+  return table;
+}
+
+constexpr std::array<std::array<Bitboard, NumberOfSquares>, LAST_DIRECTION> createRays() {
+  std::array<std::array<Bitboard, NumberOfSquares>, LAST_DIRECTION> table{};
+  for (int direction = 0; direction < LAST_DIRECTION; ++direction) {
+    for (int square = 0; square < 64; ++square) {
+      const Step s = DirectionSteps[direction];
+      int letter = (square & 7) + s.letter;
+      int number = (square >> 3) + s.number;
+      while (letter >= 0 && letter <= 7 && number >= 0 && number <= 7) {
+        table[direction][square] |= squareBB(number * 8 + letter);
+        letter += s.letter;
+        number += s.number;
+      }
+    }
+  }
+  return table;
+}
+
+}  // namespace detail
+
+constexpr std::array<Bitboard, NumberOfSquares> KnightAttacks = detail::createKnightAttacks();
+constexpr std::array<Bitboard, NumberOfSquares> KingAttacks = detail::createKingAttacks();
+// Fields attacked by a pawn of the given color standing on the square.
+constexpr std::array<std::array<Bitboard, NumberOfSquares>, 2> PawnAttacks = detail::createPawnAttacks();
+// Fields from the square to the edge of the board in the given direction.
+constexpr std::array<std::array<Bitboard, NumberOfSquares>, LAST_DIRECTION> Rays = detail::createRays();
+
+// North, east and both northern diagonals walk towards higher squares, so the
+// nearest blocker is the lowest bit; the other directions use the highest one.
+inline int firstBlocker(Direction direction, Bitboard blockers) {
+  return direction < SOUTH ? lsb(blockers) : msb(blockers);
+}
+
+inline Bitboard rayAttacks(Direction direction, int square, Bitboard occupied) {
+  Bitboard attacks = Rays[direction][square];
+  const Bitboard blockers = attacks & occupied;
+  if (blockers != 0) {
+    attacks ^= Rays[direction][firstBlocker(direction, blockers)];
+  }
+  return attacks;
+}
+
+inline Bitboard rookAttacks(int square, Bitboard occupied) {
+  return rayAttacks(NORTH, square, occupied) | rayAttacks(EAST, square, occupied) |
+         rayAttacks(SOUTH, square, occupied) | rayAttacks(WEST, square, occupied);
+}
+
+inline Bitboard bishopAttacks(int square, Bitboard occupied) {
+  return rayAttacks(NORTH_EAST, square, occupied) | rayAttacks(NORTH_WEST, square, occupied) |
+         rayAttacks(SOUTH_EAST, square, occupied) | rayAttacks(SOUTH_WEST, square, occupied);
+}
+
+inline bool isDiagonal(Direction direction) {
+  return direction == NORTH_EAST || direction == NORTH_WEST ||
+         direction == SOUTH_EAST || direction == SOUTH_WEST;
+}
+
+}  // namespace bitboard
+
+#endif  // BITBOARD_H
@@ -1,6 +1,7 @@
 #include "Board.h"
 
 #include <algorithm>
+#include <cstring>
 #include <sstream>
 
 #include "utils/Utils.h"
@@ -8,6 +9,71 @@
 
 int Board::number_of_copies_ = 0;
 
+namespace {
+
+// Adds a move for every target field; the origin is the target shifted back
+// by Offset.
+template<int Offset>
+void addPawnMoves(Bitboard targets, bool beaten, std::vector<Figure::Move>& moves) {
+  while (targets != 0) {
+    const int to = bitboard::popLsb(targets);
+    moves.emplace_back(bitboard::toField(to - Offset), bitboard::toField(to), false, false,
+                       Figure::Move::Castling::LAST, beaten, Figure::PAWN);
+  }
+}
+
+template<int Offset>
+void addPawnPromotions(Bitboard targets, bool beaten, std::vector<Figure::Move>& moves) {
+  while (targets != 0) {
+    const int to = bitboard::popLsb(targets);
+    const Field old_field = bitboard::toField(to - Offset);
+    const Field new_field = bitboard::toField(to);
+    for (Figure::Type promotion: {Figure::BISHOP, Figure::KNIGHT, Figure::ROOK, Figure::QUEEN}) {
+      moves.emplace_back(old_field, new_field, false, false,
+                         Figure::Move::Castling::LAST, beaten, promotion);
+    }
+  }
+}
+
+// Random keys for Zobrist hashing, generated with splitmix64 so they are
+// the same in every build.
+struct ZobristKeys {
+  // Indexed by figure code (see Figure::createCode) and square.
+  uint64_t figures[16][bitboard::NumberOfSquares]{};
+  uint64_t castlings[static_cast<int>(Figure::Move::Castling::LAST)]{};
+  uint64_t en_passant_files[Board::BoardSize]{};
+  uint64_t black_to_move{0};
+};
+
+constexpr uint64_t splitMix64(uint64_t& state) {
+  uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+constexpr ZobristKeys createZobristKeys() {
+  ZobristKeys keys;
+  uint64_t state = 0x2545F4914F6CDD1DULL;
+  for (auto& code_keys: keys.figures) {
+    for (auto& key: code_keys) {
+      key = splitMix64(state);
+    }
+  }
+  for (auto& key: keys.castlings) {
+    key = splitMix64(state);
+  }
+  for (auto& key: keys.en_passant_files) {
+    key = splitMix64(state);
+  }
+  keys.black_to_move = splitMix64(state);
+  return keys;
+}
+
+constexpr ZobristKeys g_zobrist_keys = createZobristKeys();
+
+}  // unnamed namespace
+
 std::ostream& operator<<(std::ostream& ostr, Board::GameStatus status) {
   ostr << static_cast<int>(status);
   return ostr;
@@ -18,7 +84,7 @@ std::ostream& operator<<(std::ostream& ostr, const Board& board) {
   for (const auto& row : board.fields_) {
     ostr << "{";
     for (const auto& item : row) {
-      ostr << item << ", ";
+      ostr << static_cast<int>(item) << ", ";
     }
     ostr << "},";
   }
@@ -27,16 +93,18 @@ std::ostream& operator<<(std::ostream& ostr, const Board& board) {
 }
 
 Board::Board() noexcept {
-  std::array<Figure*, BoardSize> row;
-  row.fill(nullptr);
+  std::array<uint8_t, BoardSize> row;
+  row.fill(Figure::NoFigure);
   fields_.fill(row);
+  for (auto& lists: figures_lists_) {
+    for (auto& list: lists) {
+      list.reserve(MaxFiguresOfOneType);
+    }
+  }
 }
 
-Board::Board(const Board& other) noexcept {
+Board::Board(const Board& other) noexcept : Board() {
   ++number_of_copies_;
-  std::array<Figure*, BoardSize> row;
-  row.fill(nullptr);
-  fields_.fill(row);
 
   const auto& figures = other.getFigures();
   for (const auto& figure : figures) {
@@ -48,56 +116,91 @@ Board::Board(const Board& other) noexcept {
   halfmove_clock_ = other.halfmove_clock_;
   fullmove_number_ = other.fullmove_number_;
   side_to_move_ = other.side_to_move_;
+  if (other.attack_maps_enabled_ == true) {
+    enableAttackMaps(true);
+  }
 }
 
 bool Board::isMoveValid(Field old_field, Field new_field) {
-  Figure* figure = fields_[old_field.letter][old_field.number];
+  const Figure* figure = getFigure(old_field);
   if (figure == nullptr) {
     return false;
   }
 
-  if (figure->getColor() != side_to_move_) {
+  const Figure::Color color = figure->getColor();
+  if (color != side_to_move_) {
     return false;
   }
 
-  try {
-    GameStatus status = getGameStatus(figure->getColor());
-    if (status != GameStatus::NONE) {
-      return false;
-    }
-  } catch (const BadBoardStatusException&) {
+  // Finished games can't be continued, but mates and stalemates need no
+  // separate test: no move passes the legality test below in them.
+  if (getKing(Figure::WHITE) == nullptr || getKing(Figure::BLACK) == nullptr ||
+      isDraw() == true || isKingChecked(!color) == true) {
     return false;
   }
 
-  auto possible_moves = calculateMovesForFigure(figure);
-  auto iter = std::find_if(possible_moves.begin(), possible_moves.end(),
-      [new_field](const auto& m) -> bool {
-        return new_field == m.new_field;
-      });
-
-  return iter != possible_moves.end();
+  Figure::Move move(old_field, new_field, Figure::PAWN);
+  if (Figure::Move::isPromotion(this, old_field, new_field) == true) {
+    move.pawn_promotion = Figure::QUEEN;
+  }
+  return isMovePseudoLegal(move) == true && isMoveLegal(move, color) == true;
 }
 
-bool Board::operator==(const Board& other) const noexcept {
-  for (size_t i = 0; i < BoardSize; ++i) {
-    for (size_t j = 0; j < BoardSize; ++j) {
-      const Figure* f1 = fields_[i][j];
-      const Figure* f2 = other.fields_[i][j];
-      if (f1 == nullptr) {
-        if (f2 == nullptr) {
-          continue;
-        } else {
-          return false;
-        }
-      } else {
-        if (f2 == nullptr) {
-          return false;
+bool Board::isMovePseudoLegal(Figure::Move& move) const {
+  using namespace bitboard;
+  const uint8_t code = fields_[move.old_field.letter][move.old_field.number];
+  if (code == Figure::NoFigure) {
+    return false;
+  }
+  const Figure::Color color = Figure::codeToColor(code);
+  const int from = toSquare(move.old_field);
+  const int to = toSquare(move.new_field);
+  const Bitboard to_bb = squareBB(to);
+  if ((color_bb_[color] & to_bb) != 0) {
+    return false;
+  }
+  const bool is_capture = (color_bb_[!color] & to_bb) != 0;
+  move.figure_beaten = is_capture;
+  move.castling = Figure::Move::Castling::LAST;
+
+  switch (Figure::codeToType(code)) {
+    case Figure::PAWN: {
+      const int up = color == Figure::WHITE ? 8 : -8;
+      const Field::Number start_line = color == Figure::WHITE ? Field::TWO : Field::SEVEN;
+      if ((PawnAttacks[color][from] & to_bb) != 0) {
+        if (is_capture == true) {
+          return true;
         }
+        const Field::Number en_passant_line = color == Figure::WHITE ? Field::SIX : Field::THREE;
+        move.figure_beaten = move.new_field.letter == en_passant_file_ &&
+                             move.new_field.number == en_passant_line;
+        return move.figure_beaten;
+      }
+      const Bitboard occupied = getOccupied();
+      if (to == from + up) {
+        return is_capture == false;
       }
-      if (*fields_[i][j] != *other.fields_[i][j]) {
+      return to == from + 2 * up && move.old_field.number == start_line &&
+             (occupied & (squareBB(from + up) | to_bb)) == 0;
+    }
+    case Figure::KING: {
+      if ((KingAttacks[from] & to_bb) != 0) {
+        return true;
+      }
+      move.castling = Figure::Move::isCastling(this, move.old_field, move.new_field);
+      if (move.castling == Figure::Move::Castling::LAST) {
         return false;
       }
+      return canCastle(move.castling);
     }
+    default:
+      return (calculateAttacks(code, from) & to_bb) != 0;
+  }
+}
+
+bool Board::operator==(const Board& other) const noexcept {
+  if (std::memcmp(fields_.data(), other.fields_.data(), sizeof(fields_)) != 0) {
+    return false;
   }
   return en_passant_file_ == other.en_passant_file_ && castlings_ == other.castlings_ &&
          halfmove_clock_ == other.halfmove_clock_ && fullmove_number_ == other.fullmove_number_;
@@ -108,13 +211,15 @@ bool Board::operator!=(const Board& other) const noexcept {
 }
 
 const Figure* Board::addFigure(Figure::Type type, Field field, Figure::Color color) {
-  const Figure* old_figure = fields_[field.letter][field.number];
+  const Figure* old_figure = getFigure(field);
   if (old_figure != nullptr) {
     throw FieldNotEmptyException(field, old_figure);
   }
   auto figure = FiguresFactory::GetFiguresFactory().createFigure(type, *this, field, color);
   Figure* new_figure = figure.get();
-  fields_[field.letter][field.number] = new_figure;
+  setField(field, new_figure->getCode());
+  figures_lists_[color][type].push_back(new_figure);
+  material_key_ += createMaterialKey(color, type);
   figures_.push_back(std::move(figure));
   for (auto drawer : drawers_) {
     drawer->onFigureAdded(type, color, field);
@@ -123,11 +228,16 @@ const Figure* Board::addFigure(Figure::Type type, Field field, Figure::Color col
 }
 
 std::unique_ptr<Figure> Board::removeFigure(Field field) {
-  const Figure* figure = fields_[field.letter][field.number];
+  size_t list_index;
+  return removeFigure(field, list_index);
+}
+
+std::unique_ptr<Figure> Board::removeFigure(Field field, size_t& list_index) {
+  const Figure* figure = getFigure(field);
   if (figure == nullptr) {
     throw NoFigureException(field);
   }
-  fields_[field.letter][field.number] = nullptr;
+  setField(field, Figure::NoFigure);
   auto iter = std::find_if(figures_.begin(), figures_.end(),
         [figure](const auto& iter) -> bool {
           return iter.get() == figure;
@@ -137,22 +247,156 @@ std::unique_ptr<Figure> Board::removeFigure(Field field) {
   std::unique_ptr<Figure> result = std::move(*iter);
   figures_.erase(iter);
 
+  auto& list = figures_lists_[figure->getColor()][figure->getType()];
+  auto list_iter = std::find(list.begin(), list.end(), figure);
+  BoardAssert(*this, list_iter != list.end());
+  list_index = list_iter - list.begin();
+  list.erase(list_iter);
+  material_key_ -= createMaterialKey(figure->getColor(), figure->getType());
+
   return result;
 }
 
+void Board::restoreFigure(std::unique_ptr<Figure> figure, size_t list_index) {
+  Field position = figure->getPosition();
+  setField(position, figure->getCode());
+  auto& list = figures_lists_[figure->getColor()][figure->getType()];
+  list.insert(list.begin() + list_index, figure.get());
+  material_key_ += createMaterialKey(figure->getColor(), figure->getType());
+  figures_.push_back(std::move(figure));
+}
+
 void Board::moveFigure(Field old_field, Field new_field) {
-  Figure* figure = fields_[old_field.letter][old_field.number];
+  Figure* figure = findFigure(old_field);
   if (figure == nullptr) {
     throw NoFigureException(old_field);
   }
-  if (fields_[new_field.letter][new_field.number] != nullptr) {
+  if (fields_[new_field.letter][new_field.number] != Figure::NoFigure) {
     throw FieldNotEmptyException(new_field, figure);
   }
-  fields_[new_field.letter][new_field.number] = figure;
-  fields_[old_field.letter][old_field.number] = nullptr;
+  setField(new_field, figure->getCode());
+  setField(old_field, Figure::NoFigure);
   figure->setPosition(new_field);
 }
 
+uint64_t Board::getHash() const noexcept {
+  uint64_t hash = figures_hash_;
+  for (size_t i = 0; i < castlings_.size(); ++i) {
+    if (castlings_[i] == true) {
+      hash ^= g_zobrist_keys.castlings[i];
+    }
+  }
+  if (en_passant_file_ != Field::NONE) {
+    hash ^= g_zobrist_keys.en_passant_files[en_passant_file_];
+  }
+  if (side_to_move_ == Figure::BLACK) {
+    hash ^= g_zobrist_keys.black_to_move;
+  }
+  return hash;
+}
+
+void Board::setField(Field field, uint8_t code) noexcept {
+  using namespace bitboard;
+  uint8_t& current = fields_[field.letter][field.number];
+  const int square = toSquare(field);
+  const Bitboard bb = squareBB(square);
+
+  // Sliders seeing the field attack through it or stop at it, so their
+  // attacks change together with its occupancy.
+  Bitboard sliders = 0;
+  if (attack_maps_enabled_ == true) {
+    const Bitboard occupied = getOccupied();
+    sliders = (bishopAttacks(square, occupied) & (type_bb_[Figure::BISHOP] | type_bb_[Figure::QUEEN])) |
+              (rookAttacks(square, occupied) & (type_bb_[Figure::ROOK] | type_bb_[Figure::QUEEN]));
+    for (Bitboard s = sliders; s != 0;) {
+      const int slider = popLsb(s);
+      removeAttacks(fields_[slider & 7][slider >> 3], slider);
+    }
+    if (current != Figure::NoFigure) {
+      removeAttacks(current, square);
+    }
+  }
+
+  if (current != Figure::NoFigure) {
+    color_bb_[Figure::codeToColor(current)] &= ~bb;
+    type_bb_[Figure::codeToType(current)] &= ~bb;
+    figures_hash_ ^= g_zobrist_keys.figures[current][square];
+  }
+  current = code;
+  if (code != Figure::NoFigure) {
+    color_bb_[Figure::codeToColor(code)] |= bb;
+    type_bb_[Figure::codeToType(code)] |= bb;
+    figures_hash_ ^= g_zobrist_keys.figures[code][square];
+  }
+
+  if (attack_maps_enabled_ == true) {
+    if (code != Figure::NoFigure) {
+      addAttacks(code, square);
+    }
+    while (sliders != 0) {
+      const int slider = popLsb(sliders);
+      addAttacks(fields_[slider & 7][slider >> 3], slider);
+    }
+  }
+}
+
+Bitboard Board::calculateAttacks(uint8_t code, int square) const noexcept {
+  using namespace bitboard;
+  switch (Figure::codeToType(code)) {
+    case Figure::PAWN:
+      return PawnAttacks[Figure::codeToColor(code)][square];
+    case Figure::KNIGHT:
+      return KnightAttacks[square];
+    case Figure::BISHOP:
+      return bishopAttacks(square, getOccupied());
+    case Figure::ROOK:
+      return rookAttacks(square, getOccupied());
+    case Figure::QUEEN:
+      return bishopAttacks(square, getOccupied()) | rookAttacks(square, getOccupied());
+    case Figure::KING:
+      return KingAttacks[square];
+  }
+  return 0;
+}
+
+void Board::addAttacks(uint8_t code, int square) noexcept {
+  const Figure::Color color = Figure::codeToColor(code);
+  Bitboard attacks = calculateAttacks(code, square);
+  while (attacks != 0) {
+    const int target = bitboard::popLsb(attacks);
+    if (attack_counts_[color][target]++ == 0) {
+      attacks_bb_[color] |= bitboard::squareBB(target);
+    }
+  }
+}
+
+void Board::removeAttacks(uint8_t code, int square) noexcept {
+  const Figure::Color color = Figure::codeToColor(code);
+  Bitboard attacks = calculateAttacks(code, square);
+  while (attacks != 0) {
+    const int target = bitboard::popLsb(attacks);
+    BoardAssert(*this, attack_counts_[color][target] > 0);
+    if (--attack_counts_[color][target] == 0) {
+      attacks_bb_[color] &= ~bitboard::squareBB(target);
+    }
+  }
+}
+
+void Board::enableAttackMaps(bool enable) noexcept {
+  attack_maps_enabled_ = enable;
+  for (auto& counts: attack_counts_) {
+    counts.fill(0);
+  }
+  attacks_bb_.fill(0);
+  if (enable == false) {
+    return;
+  }
+  for (Bitboard pieces = getOccupied(); pieces != 0;) {
+    const int square = bitboard::popLsb(pieces);
+    addAttacks(fields_[square & 7][square >> 3], square);
+  }
+}
+
 void Board::updateCastlings(const Figure::Move& move) {
   Field::Letter letter = move.old_field.letter;
   Field::Number number = move.old_field.number;
@@ -197,17 +441,61 @@ Board::ReversibleMoveWrapper Board::makeReversibleMove(Figure::Move move) {
   return Board::ReversibleMoveWrapper(*this);
 }
 
+Board::NullMoveWrapper Board::makeNullMove() noexcept {
+  BoardAssert(*this, isKingChecked(side_to_move_) == false);
+  const Field::Letter en_passant_file = en_passant_file_;
+  en_passant_file_ = Field::NONE;
+  side_to_move_ = !side_to_move_;
+  return Board::NullMoveWrapper(*this, en_passant_file);
+}
+
+void Board::undoNullMove(Field::Letter en_passant_file) noexcept {
+  side_to_move_ = !side_to_move_;
+  en_passant_file_ = en_passant_file;
+}
+
 Board::GameStatus Board::makeMove(Figure::Move move, bool rev_mode) {
-  Figure* figure = fields_[move.old_field.letter][move.old_field.number];
+  Figure* figure = findFigure(move.old_field);
   Figure::Color color = figure->getColor();
 
   if (color != side_to_move_ && rev_mode == false) {
     throw IllegalMoveException(figure, move.new_field);
   }
+  if (color == Figure::WHITE) {
+    return makeMove<Figure::WHITE>(figure, move, rev_mode);
+  }
+  return makeMove<Figure::BLACK>(figure, move, rev_mode);
+}
+
+bool Board::validateMove(Figure::Move& move) {
+  const uint8_t code = fields_[move.old_field.letter][move.old_field.number];
+  if (code == Figure::NoFigure || Figure::codeToColor(code) != side_to_move_) {
+    return false;
+  }
+  const bool is_promotion = Figure::Move::isPromotion(this, move.old_field, move.new_field);
+  if (is_promotion != (move.pawn_promotion != Figure::PAWN) || move.pawn_promotion == Figure::KING) {
+    return false;
+  }
+  return isMovePseudoLegal(move) == true && isMoveLegal(move, side_to_move_) == true;
+}
+
+void Board::makeTrustedMove(const Figure::Move& move) {
+  Figure* figure = findFigure(move.old_field);
+  BoardAssert(*this, figure != nullptr && figure->getColor() == side_to_move_);
+  if (side_to_move_ == Figure::WHITE) {
+    makeMove<Figure::WHITE>(figure, move, false, true);
+  } else {
+    makeMove<Figure::BLACK>(figure, move, false, true);
+  }
+}
+
+template<Figure::Color Us>
+Board::GameStatus Board::makeMove(Figure* figure, Figure::Move move, bool rev_mode, bool trusted) {
 
   std::unique_ptr<Figure> beaten_figure;
-  if (fields_[move.new_field.letter][move.new_field.number] != nullptr) {
-    beaten_figure = std::move(removeFigure(move.new_field));
+  size_t beaten_figure_index = 0;
+  if (fields_[move.new_field.letter][move.new_field.number] != Figure::NoFigure) {
+    beaten_figure = std::move(removeFigure(move.new_field, beaten_figure_index));
     move.figure_beaten = true;
     if (rev_mode == false) {
       for (auto drawer : drawers_) {
@@ -217,24 +505,20 @@ Board::GameStatus Board::makeMove(Figure::Move move, bool rev_mode) {
   }
 
   // Handle en passant capture
-  if (isEnPassantCapture(move) == true) {
+  if (isEnPassantCapture<Us>(move) == true) {
     Field bitten_pawn_field;
     bitten_pawn_field.letter = en_passant_file_;
-    if (color == Figure::WHITE) {
-      bitten_pawn_field.number = Field::FIVE;
-    } else {
-      bitten_pawn_field.number = Field::FOUR;
-    }
-    beaten_figure = std::move(removeFigure(bitten_pawn_field));
+    bitten_pawn_field.number = ColorTraits<Us>::EnPassantLine;
+    beaten_figure = std::move(removeFigure(bitten_pawn_field, beaten_figure_index));
   }
 
   // Handle pawn promotion
   std::unique_ptr<Figure> promoted_pawn;
+  size_t promoted_pawn_index = 0;
   if (move.pawn_promotion != Figure::PAWN) {
     BoardAssert(*this, figure->getType() == Figure::PAWN);
-    const Pawn* pawn = static_cast<const Pawn*>(figure);
-    addFigure(move.pawn_promotion, move.new_field, pawn->getColor());
-    promoted_pawn = std::move(removeFigure(move.old_field));
+    addFigure(move.pawn_promotion, move.new_field, Us);
+    promoted_pawn = std::move(removeFigure(move.old_field, promoted_pawn_index));
     if (rev_mode == false) {
       for (auto drawer : drawers_) {
         drawer->onFigureRemoved(move.old_field);
@@ -246,7 +530,9 @@ Board::GameStatus Board::makeMove(Figure::Move move, bool rev_mode) {
   if (rev_mode == true) {
     ReversibleMove reversible_move(move,
                                    std::move(beaten_figure),
+                                   beaten_figure_index,
                                    std::move(promoted_pawn),
+                                   promoted_pawn_index,
                                    en_passant_file_,
                                    castlings_,
                                    halfmove_clock_,
@@ -255,9 +541,9 @@ Board::GameStatus Board::makeMove(Figure::Move move, bool rev_mode) {
     reversible_moves_.push_back(std::move(reversible_move));
   }
 
-  side_to_move_ = !side_to_move_;
+  side_to_move_ = !Us;
 
-  if (color == Figure::BLACK) {
+  if (Us == Figure::BLACK) {
     ++fullmove_number_;
   }
 
@@ -283,14 +569,16 @@ Board::GameStatus Board::makeMove(Figure::Move move, bool rev_mode) {
 
   if (figure != nullptr) {
     figure->setPosition(move.new_field);
-    fields_[move.new_field.letter][move.new_field.number] = figure;
+    setField(move.new_field, figure->getCode());
   }
-  fields_[move.old_field.letter][move.old_field.number] = nullptr;
+  setField(move.old_field, Figure::NoFigure);
 
   if (rev_mode == false) {
-    move.is_check = isKingChecked(!color);
-    move.is_mate = isKingCheckmated(!color);
-  
+    if (trusted == false) {
+      move.is_check = isKingChecked(!Us);
+      move.is_mate = isKingCheckmated(!Us);
+    }
+
     for (auto drawer : drawers_) {
       drawer->onFigureMoved(move);
     }
@@ -303,8 +591,8 @@ Board::GameStatus Board::makeMove(Figure::Move move, bool rev_mode) {
   }
 
   GameStatus status = GameStatus::NONE;
-  if (rev_mode == false) {
-    status = getGameStatus(!color);
+  if (rev_mode == false && trusted == false) {
+    status = getGameStatus(!Us);
     if (status != GameStatus::NONE) {
       onGameFinished(status);
     }
@@ -313,43 +601,326 @@ Board::GameStatus Board::makeMove(Figure::Move move, bool rev_mode) {
   return status;
 }
 
+template<Figure::Color Us>
 bool Board::isEnPassantCapture(const Figure::Move& move) const {
-  const Figure* figure = getFigure(move.old_field);
-  if (figure == nullptr || figure->getType() != Figure::PAWN) {
-    return false;
+  return fields_[move.old_field.letter][move.old_field.number] == Figure::createCode(Figure::PAWN, Us) &&
+         move.new_field.letter == en_passant_file_ &&
+         move.new_field.number == ColorTraits<Us>::EnPassantTargetLine;
+}
+
+void Board::calculatePawnMoves(Figure::Color color, Bitboard pawns, std::vector<Figure::Move>& moves) const {
+  if (color == Figure::WHITE) {
+    calculatePawnMoves<Figure::WHITE>(pawns, moves);
+  } else {
+    calculatePawnMoves<Figure::BLACK>(pawns, moves);
   }
-  if (move.new_field.letter != en_passant_file_) {
-    return false;
+}
+
+template<Figure::Color Us>
+void Board::calculatePawnMoves(Bitboard pawns, std::vector<Figure::Move>& moves) const {
+  using namespace bitboard;
+  constexpr int Up = Us == Figure::WHITE ? 8 : -8;
+  constexpr int UpWest = Up - 1;
+  constexpr int UpEast = Up + 1;
+  constexpr Bitboard PromotionRank = Us == Figure::WHITE ? Rank8 : Rank1;
+  constexpr Bitboard DoublePushRank = Us == Figure::WHITE ? Rank4 : Rank5;
+
+  const Bitboard empty = ~getOccupied();
+  const Bitboard enemies = color_bb_[!Us];
+
+  const Bitboard pushes = shift<Up>(pawns) & empty;
+  const Bitboard double_pushes = shift<Up>(pushes) & empty & DoublePushRank;
+  const Bitboard west_captures = shift<UpWest>(pawns & ~FileA) & enemies;
+  const Bitboard east_captures = shift<UpEast>(pawns & ~FileH) & enemies;
+
+  addPawnPromotions<Up>(pushes & PromotionRank, false, moves);
+  addPawnPromotions<UpWest>(west_captures & PromotionRank, true, moves);
+  addPawnPromotions<UpEast>(east_captures & PromotionRank, true, moves);
+  addPawnMoves<Up>(pushes & ~PromotionRank, false, moves);
+  addPawnMoves<Up * 2>(double_pushes, false, moves);
+  addPawnMoves<UpWest>(west_captures & ~PromotionRank, true, moves);
+  addPawnMoves<UpEast>(east_captures & ~PromotionRank, true, moves);
+
+  addEnPassantCaptures<Us>(pawns, moves);
+}
+
+template<Figure::Color Us>
+void Board::addEnPassantCaptures(Bitboard pawns, std::vector<Figure::Move>& moves) const {
+  using namespace bitboard;
+  if (en_passant_file_ != Field::NONE) {
+    const int target = toSquare(Field(en_passant_file_, ColorTraits<Us>::EnPassantTargetLine));
+    Bitboard attackers = PawnAttacks[!Us][target] & pawns;
+    while (attackers != 0) {
+      moves.emplace_back(toField(popLsb(attackers)), toField(target), false, false,
+                         Figure::Move::Castling::LAST, true, Figure::PAWN);
+    }
   }
-  if (figure->getColor() == Figure::WHITE) {
-    if (move.new_field.number != Field::SIX) {
-      return false;
+}
+
+void Board::calculateCaptures(Figure::Color color, std::vector<Figure::Move>& moves) const {
+  if (color == Figure::WHITE) {
+    calculateCaptures<Figure::WHITE>(moves);
+  } else {
+    calculateCaptures<Figure::BLACK>(moves);
+  }
+}
+
+template<Figure::Color Us>
+void Board::calculateCaptures(std::vector<Figure::Move>& moves) const {
+  using namespace bitboard;
+  constexpr int Up = Us == Figure::WHITE ? 8 : -8;
+  constexpr int UpWest = Up - 1;
+  constexpr int UpEast = Up + 1;
+  constexpr Bitboard PromotionRank = Us == Figure::WHITE ? Rank8 : Rank1;
+
+  const Bitboard enemies = color_bb_[!Us];
+  const Bitboard pawns = getPieces(Us, Figure::PAWN);
+  const Bitboard west_captures = shift<UpWest>(pawns & ~FileA) & enemies;
+  const Bitboard east_captures = shift<UpEast>(pawns & ~FileH) & enemies;
+
+  addPawnPromotions<Up>(shift<Up>(pawns) & ~getOccupied() & PromotionRank, false, moves);
+  addPawnPromotions<UpWest>(west_captures & PromotionRank, true, moves);
+  addPawnPromotions<UpEast>(east_captures & PromotionRank, true, moves);
+  addPawnMoves<UpWest>(west_captures & ~PromotionRank, true, moves);
+  addPawnMoves<UpEast>(east_captures & ~PromotionRank, true, moves);
+  addEnPassantCaptures<Us>(pawns, moves);
+
+  for (size_t type = Figure::KNIGHT; type < NumberOfFigureTypes; ++type) {
+    const uint8_t code = Figure::createCode(static_cast<Figure::Type>(type), Us);
+    for (Bitboard figures = color_bb_[Us] & type_bb_[type]; figures != 0;) {
+      const int from = popLsb(figures);
+      Bitboard targets = calculateAttacks(code, from) & enemies;
+      while (targets != 0) {
+        moves.emplace_back(toField(from), toField(popLsb(targets)), false, false,
+                           Figure::Move::Castling::LAST, true, Figure::PAWN);
+      }
     }
+  }
+}
+
+void Board::calculateQuietChecks(Figure::Color color, const CheckInfo& info, std::vector<Figure::Move>& moves) {
+  if (color == Figure::WHITE) {
+    calculateQuietChecks<Figure::WHITE>(info, moves);
   } else {
-    if (move.new_field.number != Field::THREE) {
-      return false;
+    calculateQuietChecks<Figure::BLACK>(info, moves);
+  }
+}
+
+template<Figure::Color Us>
+void Board::calculateQuietChecks(const CheckInfo& info, std::vector<Figure::Move>& moves) {
+  using namespace bitboard;
+  constexpr int Up = Us == Figure::WHITE ? 8 : -8;
+  constexpr Bitboard PromotionRank = Us == Figure::WHITE ? Rank8 : Rank1;
+  constexpr Bitboard DoublePushRank = Us == Figure::WHITE ? Rank4 : Rank5;
+  if (info.king_square < 0) {
+    return;
+  }
+
+  // Only moves to check squares and moves of discovered check candidates are
+  // generated, givesCheck sorts out the candidates staying on the line.
+  const size_t first = moves.size();
+  const Bitboard empty = ~getOccupied();
+  const Bitboard discovering = info.discovered_check_candidates;
+  const Bitboard pawns = getPieces(Us, Figure::PAWN);
+  const Bitboard pushes = shift<Up>(pawns) & empty;
+  const Bitboard double_pushes = shift<Up>(pushes) & empty & DoublePushRank;
+  addPawnMoves<Up>(pushes & ~PromotionRank & (info.check_squares[Figure::PAWN] | shift<Up>(discovering)),
+                   false, moves);
+  addPawnMoves<Up * 2>(double_pushes & (info.check_squares[Figure::PAWN] | shift<Up * 2>(discovering)),
+                       false, moves);
+
+  for (size_t type = Figure::KNIGHT; type < NumberOfFigureTypes; ++type) {
+    const uint8_t code = Figure::createCode(static_cast<Figure::Type>(type), Us);
+    for (Bitboard figures = color_bb_[Us] & type_bb_[type]; figures != 0;) {
+      const int from = popLsb(figures);
+      Bitboard targets = calculateAttacks(code, from) & empty;
+      if ((discovering & squareBB(from)) == 0) {
+        targets &= info.check_squares[type];
+      }
+      while (targets != 0) {
+        moves.emplace_back(toField(from), toField(popLsb(targets)), false, false,
+                           Figure::Move::Castling::LAST, false, Figure::PAWN);
+      }
     }
   }
-  return true;
+  moves.erase(std::remove_if(moves.begin() + first, moves.end(),
+      [this, &info](auto& move) -> bool {
+        move.is_check = givesCheck(move, info);
+        return move.is_check == false;
+      }), moves.end());
 }
 
 bool Board::isKingChecked(Figure::Color color) {
-  const King* king = getKing(color);
-  if (king == nullptr) {
+  const Bitboard king = getPieces(color, Figure::KING);
+  if (king == 0) {
     return false;
   }
-  const auto& figures = getFigures(!color);
-  for (const auto& figure: figures) {
-    auto moves = figure->calculatePossibleMoves();
-    auto iter = std::find_if(moves.begin(), moves.end(),
-        [king](const auto& move) -> bool {
-          return move.new_field == king->getPosition();
-        });
-    if (iter != moves.end()) {
-      return true;
+  return isSquareAttacked(bitboard::lsb(king), !color, getOccupied());
+}
+
+bool Board::isSquareAttacked(int square, Figure::Color by, Bitboard occupied) const noexcept {
+  using namespace bitboard;
+  if (attack_maps_enabled_ == true && occupied == getOccupied()) {
+    return (attacks_bb_[by] & squareBB(square)) != 0;
+  }
+  const Bitboard queens = getPieces(by, Figure::QUEEN);
+  return (PawnAttacks[!by][square] & getPieces(by, Figure::PAWN)) != 0 ||
+         (KnightAttacks[square] & getPieces(by, Figure::KNIGHT)) != 0 ||
+         (KingAttacks[square] & getPieces(by, Figure::KING)) != 0 ||
+         (bishopAttacks(square, occupied) & (getPieces(by, Figure::BISHOP) | queens)) != 0 ||
+         (rookAttacks(square, occupied) & (getPieces(by, Figure::ROOK) | queens)) != 0;
+}
+
+Bitboard Board::getAttackers(int square, Bitboard occupied) const noexcept {
+  using namespace bitboard;
+  const Bitboard diagonal = type_bb_[Figure::BISHOP] | type_bb_[Figure::QUEEN];
+  const Bitboard straight = type_bb_[Figure::ROOK] | type_bb_[Figure::QUEEN];
+  return (PawnAttacks[Figure::BLACK][square] & getPieces(Figure::WHITE, Figure::PAWN)) |
+         (PawnAttacks[Figure::WHITE][square] & getPieces(Figure::BLACK, Figure::PAWN)) |
+         (KnightAttacks[square] & type_bb_[Figure::KNIGHT]) |
+         (KingAttacks[square] & type_bb_[Figure::KING]) |
+         (bishopAttacks(square, occupied) & diagonal) |
+         (rookAttacks(square, occupied) & straight);
+}
+
+int Board::calculateStaticExchange(const Figure::Move& move) const noexcept {
+  using namespace bitboard;
+  constexpr int Values[] = {PAWN_VALUE, KNIGHT_VALUE, BISHOP_VALUE, ROOK_VALUE, QUEEN_VALUE, KING_VALUE};
+  const int from = toSquare(move.old_field);
+  const int to = toSquare(move.new_field);
+  const uint8_t attacker = fields_[move.old_field.letter][move.old_field.number];
+  const uint8_t victim = fields_[move.new_field.letter][move.new_field.number];
+  Figure::Color color = Figure::codeToColor(attacker);
+  Bitboard occupied = getOccupied() ^ squareBB(from);
+
+  // gains[i] is the material balance for the side making the i-th capture.
+  std::array<int, 32> gains;
+  gains[0] = victim != Figure::NoFigure ? Values[Figure::codeToType(victim)] : 0;
+  int value_on_square = Values[Figure::codeToType(attacker)];
+  if (Figure::codeToType(attacker) == Figure::PAWN && victim == Figure::NoFigure &&
+      move.old_field.letter != move.new_field.letter) {
+    // En passant, the captured pawn doesn't stand on the target field.
+    occupied ^= squareBB(color == Figure::WHITE ? to - 8 : to + 8);
+    gains[0] = PAWN_VALUE;
+  }
+  if (move.pawn_promotion != Figure::PAWN) {
+    gains[0] += Values[move.pawn_promotion] - PAWN_VALUE;
+    value_on_square = Values[move.pawn_promotion];
+  }
+
+  Bitboard attackers = getAttackers(to, occupied) & occupied;
+  const Bitboard diagonal = type_bb_[Figure::BISHOP] | type_bb_[Figure::QUEEN];
+  const Bitboard straight = type_bb_[Figure::ROOK] | type_bb_[Figure::QUEEN];
+  size_t depth = 0;
+  while (depth + 1 < gains.size()) {
+    color = static_cast<Figure::Color>(!color);
+    const Bitboard own_attackers = attackers & color_bb_[color];
+    if (own_attackers == 0) {
+      break;
+    }
+    size_t type = Figure::PAWN;
+    while ((own_attackers & type_bb_[type]) == 0) {
+      ++type;
+    }
+    // The king can't capture a defended figure.
+    if (type == Figure::KING && (attackers & color_bb_[!color]) != 0) {
+      break;
+    }
+    ++depth;
+    gains[depth] = value_on_square - gains[depth - 1];
+    value_on_square = Values[type];
+    occupied ^= squareBB(lsb(own_attackers & type_bb_[type]));
+    // Sliders behind the capturing figure join the exchange.
+    if (type == Figure::PAWN || type == Figure::BISHOP || type == Figure::QUEEN) {
+      attackers |= bishopAttacks(to, occupied) & diagonal;
     }
+    if (type == Figure::ROOK || type == Figure::QUEEN) {
+      attackers |= rookAttacks(to, occupied) & straight;
+    }
+    attackers &= occupied;
   }
-  return false;
+  // Either side stops capturing when going on would lose material.
+  for (; depth > 0; --depth) {
+    gains[depth - 1] = -std::max(-gains[depth - 1], gains[depth]);
+  }
+  return gains[0];
+}
+
+Board::CheckInfo Board::calculateCheckInfo(Figure::Color color) const noexcept {
+  using namespace bitboard;
+  CheckInfo info;
+  const Bitboard king = getPieces(!color, Figure::KING);
+  if (king == 0) {
+    return info;
+  }
+  const int ksq = lsb(king);
+  const Bitboard occupied = getOccupied();
+  info.king_square = ksq;
+  info.check_squares[Figure::PAWN] = PawnAttacks[!color][ksq];
+  info.check_squares[Figure::KNIGHT] = KnightAttacks[ksq];
+  info.check_squares[Figure::BISHOP] = bishopAttacks(ksq, occupied);
+  info.check_squares[Figure::ROOK] = rookAttacks(ksq, occupied);
+  info.check_squares[Figure::QUEEN] = info.check_squares[Figure::BISHOP] | info.check_squares[Figure::ROOK];
+
+  // Walk every line from the enemy king: an own figure is a candidate when
+  // the next figure behind it is an own slider moving along that line.
+  const Bitboard queens = getPieces(color, Figure::QUEEN);
+  const Bitboard diagonal_sliders = getPieces(color, Figure::BISHOP) | queens;
+  const Bitboard straight_sliders = getPieces(color, Figure::ROOK) | queens;
+  for (int d = 0; d < LAST_DIRECTION; ++d) {
+    const Direction direction = static_cast<Direction>(d);
+    Bitboard blockers = Rays[direction][ksq] & occupied;
+    if (blockers == 0) {
+      continue;
+    }
+    const int first = firstBlocker(direction, blockers);
+    if ((color_bb_[color] & squareBB(first)) == 0) {
+      continue;
+    }
+    blockers = Rays[direction][first] & occupied;
+    if (blockers == 0) {
+      continue;
+    }
+    const int second = firstBlocker(direction, blockers);
+    const Bitboard sliders = isDiagonal(direction) ? diagonal_sliders : straight_sliders;
+    if ((sliders & squareBB(second)) != 0) {
+      info.discovered_check_candidates |= squareBB(first);
+    }
+  }
+  return info;
+}
+
+bool Board::givesCheck(const Figure::Move& move, const CheckInfo& info) {
+  using namespace bitboard;
+  if (info.king_square < 0) {
+    return false;
+  }
+  const uint8_t code = fields_[move.old_field.letter][move.old_field.number];
+  const Figure::Color color = Figure::codeToColor(code);
+  const Figure::Type type = Figure::codeToType(code);
+  // Castling, promotion and en passant change more than one field, they are
+  // rare enough to be checked by making the move.
+  if (move.castling != Figure::Move::Castling::LAST || move.pawn_promotion != Figure::PAWN ||
+      (type == Figure::PAWN && move.old_field.letter != move.new_field.letter &&
+       fields_[move.new_field.letter][move.new_field.number] == Figure::NoFigure)) {
+    auto wrapper = makeReversibleMove(move);
+    return isKingChecked(!color);
+  }
+
+  const Bitboard from = fieldBB(move.old_field);
+  const Bitboard to = fieldBB(move.new_field);
+  if ((info.check_squares[type] & to) != 0) {
+    return true;
+  }
+  if ((info.discovered_check_candidates & from) == 0) {
+    return false;
+  }
+  const Bitboard occupied = (getOccupied() ^ from) | to;
+  const Bitboard queens = getPieces(color, Figure::QUEEN);
+  const Bitboard diagonal_sliders = (getPieces(color, Figure::BISHOP) | queens) & ~from;
+  const Bitboard straight_sliders = (getPieces(color, Figure::ROOK) | queens) & ~from;
+  return (bishopAttacks(info.king_square, occupied) & diagonal_sliders) != 0 ||
+         (rookAttacks(info.king_square, occupied) & straight_sliders) != 0;
 }
 
 bool Board::isKingCheckmated(Figure::Color color) {
@@ -357,24 +928,7 @@ bool Board::isKingCheckmated(Figure::Color color) {
   if (king == nullptr || isKingChecked(color) == false) {
     return false;
   }
-
-  bool is_mate = true;
-  auto figures = getFigures(color);
-  for (const auto* figure: figures) {
-    auto moves = figure->calculatePossibleMoves();
-    for (const auto& move: moves) {
-      if (move.castling != Figure::Move::Castling::LAST) {
-        continue;  // You can't castle when you're in check
-      }
-      auto wrapper = makeReversibleMove(move);
-      if (isKingChecked(color) == false) {
-        is_mate = false;
-        break;
-      }
-    }
-  }
-  
-  return is_mate;
+  return hasLegalMove(color) == false;
 }
 
 bool Board::isKingStalemated(Figure::Color color) {
@@ -382,21 +936,59 @@ bool Board::isKingStalemated(Figure::Color color) {
   if (king == nullptr || isKingChecked(color) == true) {
     return false;
   }
+  return hasLegalMove(color) == false;
+}
 
-  bool is_stalemate = true;
-  auto figures = getFigures(color);
-  for (const auto* figure: figures) {
-    auto moves = figure->calculatePossibleMoves();
-    for (const auto& move: moves) {
-      auto wrapper = makeReversibleMove(move);
-      if (isKingChecked(color) == false) {
-        is_stalemate = false;
-        break;
+bool Board::hasLegalMove(Figure::Color color) {
+  LegalMoveGenerator generator(*this, color);
+  Figure::Move move;
+  return generator.next(move);
+}
+
+Board::LegalMoveGenerator::LegalMoveGenerator(Board& board, Figure::Color color) noexcept
+  : board_(board), color_(color) {
+}
+
+Board::LegalMoveGenerator::LegalMoveGenerator(Board& board, const Figure* figure) noexcept
+  : board_(board), color_(figure->getColor()), type_(NumberOfFigureTypes) {
+  pending_moves_ = figure->calculatePossibleMoves();
+}
+
+bool Board::LegalMoveGenerator::next(Figure::Move& move) {
+  while (true) {
+    while (pending_index_ < pending_moves_.size()) {
+      const Figure::Move& candidate = pending_moves_[pending_index_++];
+      if (board_.isMoveLegal(candidate, color_) == true) {
+        move = candidate;
+        return true;
       }
     }
+    if (loadNextFigure() == false) {
+      return false;
+    }
   }
+}
 
-  return is_stalemate;
+bool Board::LegalMoveGenerator::loadNextFigure() {
+  while (type_ < NumberOfFigureTypes) {
+    const auto& figures = board_.figures_lists_[color_][type_];
+    if (type_ == Figure::PAWN && figure_index_ == 0 && figures.empty() == false) {
+      // All pawns are generated at once
+      pending_moves_.clear();
+      board_.calculatePawnMoves(color_, board_.getPieces(color_, Figure::PAWN), pending_moves_);
+      pending_index_ = 0;
+      ++type_;
+      return true;
+    }
+    if (figure_index_ < figures.size()) {
+      pending_moves_ = figures[figure_index_++]->calculatePossibleMoves();
+      pending_index_ = 0;
+      return true;
+    }
+    ++type_;
+    figure_index_ = 0;
+  }
+  return false;
 }
 
 bool Board::canKingCastle(Figure::Color color) const {
@@ -414,7 +1006,7 @@ std::string Board::createFEN() const {
   for (int j = BoardSize - 1; j >= 0; --j) {
     int number_of_empty_fields = 0;
     for (int i = 0; i < static_cast<int>(BoardSize); ++i) {
-      const Figure* figure = fields_[i][j];
+      const Figure* figure = getFigure(Field(static_cast<Field::Letter>(i), static_cast<Field::Number>(j)));
       if (figure == nullptr) {
         ++number_of_empty_fields;
       } else {
@@ -689,20 +1281,16 @@ bool Board::addFiguresForOneLineFromFen(const std::string& fen, size_t line) {
 }
 
 Board::GameStatus Board::getGameStatus(Figure::Color color) {
-  const King* king = getKing(Figure::WHITE);
-  if (king == nullptr) {
-    throw BadBoardStatusException(this);
-  }
-  king = getKing(Figure::BLACK);
-  if (king == nullptr) {
+  if (getKing(Figure::WHITE) == nullptr || getKing(Figure::BLACK) == nullptr) {
     throw BadBoardStatusException(this);
   }
-  Board::GameStatus status = isCheckMate();
-  if (status == GameStatus::WHITE_WON ||
-      status == GameStatus::BLACK_WON) {
-    return status;
+  if (hasLegalMove(color) == false) {
+    if (isKingChecked(color) == true) {
+      return color == Figure::WHITE ? GameStatus::BLACK_WON : GameStatus::WHITE_WON;
+    }
+    return GameStatus::DRAW;
   }
-  if (isKingStalemated(color) || isDraw()) {
+  if (isDraw()) {
     return GameStatus::DRAW;
   }
   if (isKingChecked(!color)) {
@@ -712,33 +1300,42 @@ Board::GameStatus Board::getGameStatus(Figure::Color color) {
   return GameStatus::NONE;
 }
 
-Board::GameStatus Board::isCheckMate() {
-  if (isKingCheckmated(Figure::WHITE)) {
-    return GameStatus::BLACK_WON;
-  }
-  if (isKingCheckmated(Figure::BLACK)) {
-    return GameStatus::WHITE_WON;
+bool Board::isDraw() const {
+  if (halfmove_clock_ >= 100) {
+    return true;
   }
-  return GameStatus::NONE;
+  return isInsufficientMaterial();
 }
 
-bool Board::isDraw() const {
-  const King* king = getKing(Figure::WHITE);
-  if (king == nullptr) {
-    return false;
-  }
-  king = getKing(Figure::BLACK);
-  if (king == nullptr) {
-    return false;
-  }
-  if (halfmove_clock_ >= 100) {
+bool Board::isInsufficientMaterial() const noexcept {
+  constexpr uint64_t kings = createMaterialKey(Figure::WHITE, Figure::KING, 0xF) |
+                             createMaterialKey(Figure::BLACK, Figure::KING, 0xF);
+  constexpr uint64_t bishops = createMaterialKey(Figure::WHITE, Figure::BISHOP, 0xF) |
+                               createMaterialKey(Figure::BLACK, Figure::BISHOP, 0xF);
+  const uint64_t key = material_key_ & ~kings;
+  // KK, KNK and KBK
+  if (key == 0 ||
+      key == createMaterialKey(Figure::WHITE, Figure::KNIGHT) ||
+      key == createMaterialKey(Figure::BLACK, Figure::KNIGHT) ||
+      key == createMaterialKey(Figure::WHITE, Figure::BISHOP) ||
+      key == createMaterialKey(Figure::BLACK, Figure::BISHOP)) {
     return true;
   }
-  std::vector<const Figure*> white_figures = getFigures(Figure::WHITE);
-  std::vector<const Figure*> black_figures = getFigures(Figure::BLACK);
-  if (white_figures.size() > 1 || black_figures.size() > 1) {
+  if ((key & ~bishops) != 0) {
     return false;
   }
+  // Only bishops left: it is a draw when all of them move on the same color.
+  int squares_color = -1;
+  for (const auto& figures: figures_lists_) {
+    for (const Figure* bishop: figures[Figure::BISHOP]) {
+      Field position = bishop->getPosition();
+      int color = (position.letter + position.number) % 2;
+      if (squares_color != -1 && squares_color != color) {
+        return false;
+      }
+      squares_color = color;
+    }
+  }
   return true;
 }
 
@@ -753,7 +1350,7 @@ bool Board::canCastle(Figure::Move::Castling castling) const {
 }
 
 Board::GameStatus Board::makeMove(Field old_field, Field new_field, Figure::Type promotion, bool rev_mode) {
-  Figure* figure = fields_[old_field.letter][old_field.number];
+  const Figure* figure = getFigure(old_field);
   if (figure == nullptr) {
     throw NoFigureException(old_field);
   }
@@ -781,68 +1378,102 @@ Board::GameStatus Board::makeMove(Field old_field, Field new_field, Figure::Type
   return makeMove(move, rev_mode);
 }
 
-bool Board::isMoveValid(Figure::Move& move, Figure::Color color) {
-  if (move.castling != Figure::Move::Castling::LAST) {
-    if (castlings_[static_cast<size_t>(move.castling)] == false) {
-      return false;
-    }
-    if (isKingChecked(color) == true) {
-      return false;
-    }
-    const Field::Number number = color == Figure::WHITE ? Field::ONE : Field::EIGHT;
-    const int offset = move.castling == Figure::Move::Castling::K || move.castling == Figure::Move::Castling::k ? 1 : -1;
-    const Field new_field(static_cast<Field::Letter>(move.old_field.letter + offset), number);
-    moveFigure(move.old_field, new_field);
-    bool is_king_checked = isKingChecked(color);
-    moveFigure(new_field, move.old_field);
-    if (is_king_checked == true) {
-      return false;
-    }
+bool Board::isCastlingPathSafe(const Figure::Move& move, Figure::Color color) {
+  if (castlings_[static_cast<size_t>(move.castling)] == false) {
+    return false;
   }
-  
+  if (isKingChecked(color) == true) {
+    return false;
+  }
+  // The king is not in check, so nothing attacks the passed field through
+  // the king's own field and the current occupancy can be used.
+  const Field::Number number = color == Figure::WHITE ? Field::ONE : Field::EIGHT;
+  const int offset = move.castling == Figure::Move::Castling::K || move.castling == Figure::Move::Castling::k ? 1 : -1;
+  const Field passed_field(static_cast<Field::Letter>(move.old_field.letter + offset), number);
+  return isSquareAttacked(bitboard::toSquare(passed_field), !color, getOccupied()) == false;
+}
+
+bool Board::isMoveLegal(const Figure::Move& move, Figure::Color color) {
+  if (move.castling != Figure::Move::Castling::LAST &&
+      isCastlingPathSafe(move, color) == false) {
+    return false;
+  }
+  auto wrapper = makeReversibleMove(move);
+  return isKingChecked(color) == false;
+}
+
+bool Board::isMoveValid(Figure::Move& move, Figure::Color color, const CheckInfo& info) {
+  if (move.castling != Figure::Move::Castling::LAST &&
+      isCastlingPathSafe(move, color) == false) {
+    return false;
+  }
+
+  const bool gives_check = givesCheck(move, info);
   auto wrapper = makeReversibleMove(move);
   if (isKingChecked(color) == true) {
     return false;
   }
 
-  if (isKingChecked(!color)) {
+  if (gives_check == true) {
     move.is_check = true;
-  }
-  if (isKingCheckmated(!color)) {
-    move.is_mate = true;
+    move.is_mate = hasLegalMove(!color) == false;
   }
   return true;
 }
 
 std::vector<Figure::Move> Board::calculateMovesForFigure(const Figure* figure) {
+  return calculateMovesForFigure(figure, calculateCheckInfo(figure->getColor()));
+}
+
+std::vector<Figure::Move> Board::calculateMovesForFigure(const Figure* figure, const CheckInfo& info) {
   std::vector<Figure::Move> moves = figure->calculatePossibleMoves();
   moves.erase(std::remove_if(moves.begin(), moves.end(),
-      [this, figure](auto& move) -> bool {
-        return isMoveValid(move, figure->getColor()) == false;
+      [this, figure, &info](auto& move) -> bool {
+        return isMoveValid(move, figure->getColor(), info) == false;
       }), moves.end());
   return moves;
 }
 
 std::vector<Figure::Move> Board::calculateMovesForFigures(Figure::Color color) {
   std::vector<Figure::Move> all_moves;
-  auto figures = getFigures(color);
-  for (const auto* figure: figures) {
-    auto moves = calculateMovesForFigure(figure);
-    all_moves.insert(all_moves.end(), moves.begin(), moves.end());
+  const CheckInfo info = calculateCheckInfo(color);
+  calculatePawnMoves(color, getPieces(color, Figure::PAWN), all_moves);
+  all_moves.erase(std::remove_if(all_moves.begin(), all_moves.end(),
+      [this, color, &info](auto& move) -> bool {
+        return isMoveValid(move, color, info) == false;
+      }), all_moves.end());
+  for (size_t type = Figure::KNIGHT; type < NumberOfFigureTypes; ++type) {
+    const auto& figures = figures_lists_[color][type];
+    for (size_t i = 0; i < figures.size(); ++i) {
+      auto moves = calculateMovesForFigure(figures[i], info);
+      all_moves.insert(all_moves.end(), moves.begin(), moves.end());
+    }
   }
   return all_moves;
 }
 
 const Figure* Board::getFigure(Field field) const noexcept {
-  return fields_[field.letter][field.number];
+  const uint8_t code = fields_[field.letter][field.number];
+  if (code == Figure::NoFigure) {
+    return nullptr;
+  }
+  for (const Figure* figure: figures_lists_[Figure::codeToColor(code)][Figure::codeToType(code)]) {
+    if (figure->getPosition() == field) {
+      return figure;
+    }
+  }
+  return nullptr;
+}
+
+Figure* Board::findFigure(Field field) noexcept {
+  // Board owns all of its figures, it is safe to hand out a mutable pointer here.
+  return const_cast<Figure*>(getFigure(field));
 }
 
 std::vector<const Figure*> Board::getFigures(Figure::Color color) const noexcept {
   std::vector<const Figure*> figures;
-  for (const auto& figure: figures_) {
-    if (figure->getColor() == color) {
-      figures.push_back(figure.get());
-    }
+  for (const auto& list: figures_lists_[color]) {
+    figures.insert(figures.end(), list.begin(), list.end());
   }
   return figures;
 }
@@ -868,35 +1499,25 @@ std::string Board::getFENForCastlings() const noexcept {
 }
 
 const King* Board::getKing(Figure::Color color) const noexcept {
-  for (size_t i = 0; i < BoardSize; ++i) {
-    for (size_t j = 0; j < BoardSize; ++j) {
-      const Figure* figure = fields_[i][j];
-      if (figure && figure->getType() == Figure::KING && figure->getColor() == color) {
-        return static_cast<const King*>(figure);
-      }
-    }
+  const auto& kings = figures_lists_[color][Figure::KING];
+  if (kings.empty() == true) {
+    return nullptr;
   }
-  return nullptr;
+  return static_cast<const King*>(kings.front());
 }
 
 void Board::undoLastReversibleMove() {
   BoardAssert(*this, reversible_moves_.empty() == false);
   ReversibleMove reversible_move = std::move(reversible_moves_.back());
   reversible_moves_.pop_back();
-  Figure* promoted_pawn = reversible_move.promoted_pawn.get();
-  if (promoted_pawn != nullptr) {
-    figures_.push_back(std::move(reversible_move.promoted_pawn));
-    Field old_position = promoted_pawn->getPosition();
-    fields_[old_position.letter][old_position.number] = promoted_pawn;
+  if (reversible_move.promoted_pawn != nullptr) {
+    restoreFigure(std::move(reversible_move.promoted_pawn), reversible_move.promoted_pawn_index);
     removeFigure(reversible_move.new_field);
   } else {
     moveFigure(reversible_move.new_field, reversible_move.old_field);
   }
-  Figure* bitten_figure = reversible_move.bitten_figure.get();
-  if (bitten_figure != nullptr) {
-    figures_.push_back(std::move(reversible_move.bitten_figure));
-    Field old_position = bitten_figure->getPosition();
-    fields_[old_position.letter][old_position.number] = bitten_figure;
+  if (reversible_move.bitten_figure != nullptr) {
+    restoreFigure(std::move(reversible_move.bitten_figure), reversible_move.bitten_figure_index);
   }
   if (reversible_move.castling_move == true) {
     Field::Number line = reversible_move.old_field.number;
@@ -922,7 +1543,7 @@ void Board::undoAllReversibleMoves() {
 void Board::clearBoard() {
   for (size_t i = 0; i < BoardSize; ++i) {
     for (size_t j = 0; j < BoardSize; ++j) {
-      if (fields_[i][j] != nullptr) {
+      if (fields_[i][j] != Figure::NoFigure) {
         Field field(static_cast<Field::Letter>(i), static_cast<Field::Number>(j));
         removeFigure(field);
         for (auto drawer : drawers_) {
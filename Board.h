@@ -3,12 +3,14 @@
 
 #include <array>
 #include <cassert>
+#include <cstdint>
 #include <iostream>
 #include <memory>
 #include <stdexcept>
 #include <utility>
 #include <vector>
 
+#include "Bitboard.h"
 #include "Field.h"
 #include "Figure.h"
 
@@ -31,6 +33,14 @@ class Board {
  public:
   static int number_of_copies_;
   constexpr static size_t BoardSize = 8;
+  constexpr static size_t NumberOfFigureTypes = 6;
+  constexpr static size_t MaxFiguresOfOneType = 10;
+
+  // Material key packs the number of figures of every color and type into
+  // four bits each, so equal material gives equal keys.
+  static constexpr uint64_t createMaterialKey(Figure::Color color, Figure::Type type, unsigned count = 1) {
+    return static_cast<uint64_t>(count) << ((color * NumberOfFigureTypes + type) * 4);
+  }
 
   enum class GameStatus {
     NONE,
@@ -67,7 +77,9 @@ class Board {
     ReversibleMove(
         Figure::Move& move,
         std::unique_ptr<Figure> bf,
+        size_t bfi,
         std::unique_ptr<Figure> pp,
+        size_t ppi,
         Field::Letter epf,
         std::array<bool, static_cast<int>(Figure::Move::Castling::LAST)>& cast,
         unsigned hc,
@@ -76,8 +88,10 @@ class Board {
       : old_field(move.old_field),
         new_field(move.new_field),
         bitten_figure(std::move(bf)),
+        bitten_figure_index(bfi),
         en_passant_file(epf),
         promoted_pawn(std::move(pp)),
+        promoted_pawn_index(ppi),
         castling_move(move.castling != Figure::Move::Castling::LAST),
         castlings(cast),
         halfmove_clock(hc),
@@ -89,8 +103,10 @@ class Board {
       : old_field(other.old_field),
         new_field(other.new_field),
         bitten_figure(std::move(other.bitten_figure)),
+        bitten_figure_index(other.bitten_figure_index),
         en_passant_file(other.en_passant_file),
         promoted_pawn(std::move(other.promoted_pawn)),
+        promoted_pawn_index(other.promoted_pawn_index),
         castling_move(other.castling_move),
         castlings(other.castlings),
         halfmove_clock(other.halfmove_clock),
@@ -101,8 +117,10 @@ class Board {
     Field old_field;
     Field new_field;
     std::unique_ptr<Figure> bitten_figure;
+    size_t bitten_figure_index{0};  // position in figures_lists_, restored on undo
     Field::Letter en_passant_file{Field::Letter::NONE};
     std::unique_ptr<Figure> promoted_pawn;
+    size_t promoted_pawn_index{0};
     bool castling_move{false};
     std::array<bool, static_cast<int>(Figure::Move::Castling::LAST)> castlings{true, true, true, true};
     unsigned halfmove_clock{0};
@@ -110,6 +128,16 @@ class Board {
     Figure::Color side_to_move{Figure::WHITE};
   };
 
+  // Precomputed for the side to move, answers whether a move gives check
+  // without making it. check_squares[type] holds the fields from which a
+  // figure of that type attacks the enemy king, discovered_check_candidates
+  // holds own figures standing between an own slider and the enemy king.
+  struct CheckInfo {
+    std::array<Bitboard, NumberOfFigureTypes> check_squares{};
+    Bitboard discovered_check_candidates{0};
+    int king_square{-1};
+  };
+
   class ReversibleMoveWrapper {
    public:
     ReversibleMoveWrapper(Board& board) : board_(board) {
@@ -123,6 +151,46 @@ class Board {
     Board& board_;
   };
 
+  // Passes the move to the opponent for the lifetime of the wrapper.
+  class NullMoveWrapper {
+   public:
+    NullMoveWrapper(Board& board, Field::Letter en_passant_file)
+      : board_(board), en_passant_file_(en_passant_file) {
+    }
+
+    ~NullMoveWrapper() {
+      board_.undoNullMove(en_passant_file_);
+    }
+
+   private:
+    Board& board_;
+    const Field::Letter en_passant_file_;
+  };
+
+  // Produces legal moves one at a time, either for all figures of one color
+  // or for a single figure. Pseudo legal moves are generated per figure only
+  // when the previous figure is exhausted, and legality is checked for every
+  // move just before it is returned, so a consumer that stops pulling early
+  // does not pay for the rest. The board may be changed between calls as
+  // long as every change is undone before the next call.
+  class LegalMoveGenerator {
+   public:
+    LegalMoveGenerator(Board& board, Figure::Color color) noexcept;
+    LegalMoveGenerator(Board& board, const Figure* figure) noexcept;
+
+    bool next(Figure::Move& move);
+
+   private:
+    bool loadNextFigure();
+
+    Board& board_;
+    const Figure::Color color_;
+    size_t type_{0};
+    size_t figure_index_{0};
+    std::vector<Figure::Move> pending_moves_;
+    size_t pending_index_{0};
+  };
+
   Board() noexcept;
   Board(const Board& other) noexcept;
 
@@ -133,15 +201,33 @@ class Board {
   GameStatus makeMove(Field old_field, Field new_field, Figure::Type promotion = Figure::PAWN, bool rev_mode = false);
   GameStatus makeMove(Figure::Move move, bool rev_mode = false);
   ReversibleMoveWrapper makeReversibleMove(Figure::Move move);
+  // Null move: only the side to move changes and the en passant capture is
+  // lost, figures and move counters stay. Not allowed when in check.
+  NullMoveWrapper makeNullMove() noexcept;
+  // Checks a single move of the side to move (e.g. received from a GUI)
+  // without any mate or game status tests, and completes its castling and
+  // capture flags so it can be passed to makeTrustedMove.
+  bool validateMove(Figure::Move& move);
+  // Applies a move known to be legal: no validation, no check, mate or game
+  // status detection. Meant for replaying move lists.
+  void makeTrustedMove(const Figure::Move& move);
   const Figure* getFigure(Field field) const noexcept;
   const std::vector<std::unique_ptr<Figure>>& getFigures() const noexcept { return figures_; }
   std::vector<const Figure*> getFigures(Figure::Color color) const noexcept;
+  const std::vector<const Figure*>& getFigures(Figure::Color color, Figure::Type type) const noexcept {
+    return figures_lists_[color][type];
+  }
   const auto& getFields() const noexcept { return fields_; }
   Field::Letter getEnPassantFile() const noexcept { return en_passant_file_; }
   std::string getFENForCastlings() const noexcept;
   unsigned getHalfMoveClock() const noexcept { return halfmove_clock_ / 2; }
   unsigned getFullMoveNumber() const noexcept { return fullmove_number_; }
   const King* getKing(Figure::Color color) const noexcept;
+  uint64_t getMaterialKey() const noexcept { return material_key_; }
+  // Zobrist hash of the position: figures, castlings, en passant file and
+  // side to move. Move counters are not part of it.
+  uint64_t getHash() const noexcept;
+  bool isInsufficientMaterial() const noexcept;
   void clearBoard();
   void setStandardBoard();
   Figure::Color getSideToMove() const { return side_to_move_; }
@@ -150,8 +236,39 @@ class Board {
   void addBoardDrawer(BoardDrawer* drawer) noexcept;
   void removeBoardDrawer(BoardDrawer* drawer) noexcept;
   std::vector<Figure::Move> calculateMovesForFigure(const Figure* figure);
+  void calculatePawnMoves(Figure::Color color, Bitboard pawns, std::vector<Figure::Move>& moves) const;
   std::vector<Figure::Move> calculateMovesForFigures(Figure::Color color);
+  // Pseudo legal moves straight from the bitboards, the king may be left in
+  // check and no mates are detected. Meant for searches which make only a
+  // few of the moves and test the legality of just those.
+  void calculateCaptures(Figure::Color color, std::vector<Figure::Move>& moves) const;
+  // Quiet moves giving check, castlings and promotions excluded.
+  void calculateQuietChecks(Figure::Color color, const CheckInfo& info, std::vector<Figure::Move>& moves);
   bool isKingChecked(Figure::Color color);
+  bool isSquareAttacked(int square, Figure::Color by, Bitboard occupied) const noexcept;
+  // Figures of both colors attacking the square when only the given fields
+  // are occupied.
+  Bitboard getAttackers(int square, Bitboard occupied) const noexcept;
+  // Static exchange evaluation: material won by the side making the move when
+  // both sides keep recapturing on its target field with the least valuable
+  // figure and may stop at any time. Pins are not taken into account.
+  int calculateStaticExchange(const Figure::Move& move) const noexcept;
+  CheckInfo calculateCheckInfo(Figure::Color color) const noexcept;
+  bool givesCheck(const Figure::Move& move, const CheckInfo& info);
+  // Attack maps are kept up to date on every change of the board only after
+  // they are enabled, searches that ask for attacks often opt in, others
+  // don't pay for the updates.
+  void enableAttackMaps(bool enable) noexcept;
+  bool areAttackMapsEnabled() const noexcept { return attack_maps_enabled_; }
+  Bitboard getAttacks(Figure::Color color) const noexcept { return attacks_bb_[color]; }
+  unsigned getNumberOfAttackers(Figure::Color color, Field field) const noexcept {
+    return attack_counts_[color][bitboard::toSquare(field)];
+  }
+  Bitboard getOccupied() const noexcept { return color_bb_[Figure::WHITE] | color_bb_[Figure::BLACK]; }
+  Bitboard getPieces(Figure::Color color) const noexcept { return color_bb_[color]; }
+  Bitboard getPieces(Figure::Color color, Figure::Type type) const noexcept {
+    return color_bb_[color] & type_bb_[type];
+  }
   bool isKingCheckmated(Figure::Color color);
   bool isKingStalemated(Figure::Color color);
   bool canKingCastle(Figure::Color color) const;
@@ -166,18 +283,35 @@ class Board {
 
   void undoLastReversibleMove();
   void undoAllReversibleMoves();
+  void undoNullMove(Field::Letter en_passant_file) noexcept;
 
  private:
   Board& operator=(const Board& other) = delete;
   Board(Board&& other) = delete;
 
-  GameStatus isCheckMate();
   bool isDraw() const;
+  bool hasLegalMove(Figure::Color color);
   void onGameFinished(GameStatus status) noexcept;
-  bool isMoveValid(Figure::Move& move, Figure::Color color);
-  bool isEnPassantCapture(const Figure::Move& move) const;
+  bool isMoveValid(Figure::Move& move, Figure::Color color, const CheckInfo& info);
+  std::vector<Figure::Move> calculateMovesForFigure(const Figure* figure, const CheckInfo& info);
+  bool isMoveLegal(const Figure::Move& move, Figure::Color color);
+  bool isMovePseudoLegal(Figure::Move& move) const;
+  bool isCastlingPathSafe(const Figure::Move& move, Figure::Color color);
+  template<Figure::Color Us> GameStatus makeMove(Figure* figure, Figure::Move move, bool rev_mode, bool trusted = false);
+  template<Figure::Color Us> bool isEnPassantCapture(const Figure::Move& move) const;
+  template<Figure::Color Us> void calculatePawnMoves(Bitboard pawns, std::vector<Figure::Move>& moves) const;
+  template<Figure::Color Us> void addEnPassantCaptures(Bitboard pawns, std::vector<Figure::Move>& moves) const;
+  template<Figure::Color Us> void calculateCaptures(std::vector<Figure::Move>& moves) const;
+  template<Figure::Color Us> void calculateQuietChecks(const CheckInfo& info, std::vector<Figure::Move>& moves);
   bool canCastle(Figure::Move::Castling castling) const;
   void moveFigure(Field old_field, Field new_field);
+  void setField(Field field, uint8_t code) noexcept;
+  Bitboard calculateAttacks(uint8_t code, int square) const noexcept;
+  void addAttacks(uint8_t code, int square) noexcept;
+  void removeAttacks(uint8_t code, int square) noexcept;
+  Figure* findFigure(Field field) noexcept;
+  std::unique_ptr<Figure> removeFigure(Field field, size_t& list_index);
+  void restoreFigure(std::unique_ptr<Figure> figure, size_t list_index);
   void updateCastlings(const Figure::Move& move);
   bool addFiguresForOneLineFromFen(const std::string& fen, size_t line);
   bool setCastlingsFromFen(const std::string& fen);
@@ -185,8 +319,25 @@ class Board {
 
   Field::Letter en_passant_file_{Field::Letter::NONE};
   std::vector<std::unique_ptr<Figure>> figures_;
+  // Figures grouped by color and type. Every list keeps its order across
+  // makeMove/undoLastReversibleMove, so it can be iterated by index while
+  // moves are being made and undone.
+  std::array<std::array<std::vector<const Figure*>, NumberOfFigureTypes>, 2> figures_lists_;
+  uint64_t material_key_{0};
+  // Zobrist keys of all figures on the board, kept in sync by setField.
+  uint64_t figures_hash_{0};
   std::vector<BoardDrawer*> drawers_;
-  std::array<std::array<Figure*, BoardSize>, BoardSize> fields_;
+  // One byte code per field (see Figure::createCode), so the whole board
+  // fits in a single cache line.
+  alignas(64) std::array<std::array<uint8_t, BoardSize>, BoardSize> fields_;
+  // Occupancy kept in sync with fields_ by setField.
+  std::array<Bitboard, 2> color_bb_{0, 0};
+  std::array<Bitboard, NumberOfFigureTypes> type_bb_{0, 0, 0, 0, 0, 0};
+  // Number of figures of every color attacking every field and the set of
+  // attacked fields, valid only when attack_maps_enabled_ is set.
+  bool attack_maps_enabled_{false};
+  std::array<std::array<uint8_t, bitboard::NumberOfSquares>, 2> attack_counts_{};
+  std::array<Bitboard, 2> attacks_bb_{0, 0};
   std::vector<ReversibleMove> reversible_moves_;
   std::array<bool, static_cast<int>(Figure::Move::Castling::LAST)> castlings_{true, true, true, true};
   unsigned halfmove_clock_{0};
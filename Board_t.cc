@@ -494,4 +494,296 @@ TEST_PROCEDURE(BoardCanKingCastleWorksCorrectly) {
   TEST_END
 }
 
+TEST_PROCEDURE(BoardGetGameStatusWorksCorrectly) {
+  TEST_START
+  Board board;
+  VERIFY_TRUE(board.setBoardFromFEN("k7/2Q5/1K6/8/8/8/8/8 b - - 0 1"));
+  VERIFY_EQUALS(board.getGameStatus(Figure::BLACK), Board::GameStatus::DRAW);
+  VERIFY_TRUE(board.setBoardFromFEN("k1Q5/8/1K6/8/8/8/8/8 b - - 0 1"));
+  VERIFY_EQUALS(board.getGameStatus(Figure::BLACK), Board::GameStatus::WHITE_WON);
+  VERIFY_TRUE(board.setBoardFromFEN("7k/8/8/8/8/8/5PPP/3r2K1 w - - 0 1"));
+  VERIFY_EQUALS(board.getGameStatus(Figure::WHITE), Board::GameStatus::BLACK_WON);
+  VERIFY_TRUE(board.setBoardFromFEN("4k3/8/8/8/8/8/8/r3K2R w K - 0 1"));
+  VERIFY_EQUALS(board.getGameStatus(Figure::WHITE), Board::GameStatus::NONE);
+  TEST_END
+}
+
+TEST_PROCEDURE(BoardFiguresListsAreUpdatedCorrectly) {
+  TEST_START
+  Board board;
+  VERIFY_TRUE(board.setBoardFromFEN("1n2k3/P7/8/8/8/8/8/4K3 w - - 0 1"));
+  const Figure* pawn = board.getFigure(Field("a7"));
+  const Figure* knight = board.getFigure(Field("b8"));
+  VERIFY_EQUALS(board.getFigures(Figure::WHITE, Figure::PAWN).size(), 1ul);
+  VERIFY_EQUALS(board.getFigures(Figure::BLACK, Figure::KNIGHT).size(), 1ul);
+  board.makeMove(Figure::Move(Field("a7"), Field("b8"), Figure::QUEEN), true);
+  VERIFY_EQUALS(board.getFigures(Figure::WHITE, Figure::PAWN).size(), 0ul);
+  VERIFY_EQUALS(board.getFigures(Figure::WHITE, Figure::QUEEN).size(), 1ul);
+  VERIFY_EQUALS(board.getFigures(Figure::BLACK, Figure::KNIGHT).size(), 0ul);
+  VERIFY_EQUALS(board.getFigures(Figure::BLACK).size(), 1ul);
+  board.undoLastReversibleMove();
+  VERIFY_EQUALS(board.getFigures(Figure::WHITE, Figure::QUEEN).size(), 0ul);
+  VERIFY_EQUALS(board.getFigures(Figure::WHITE, Figure::PAWN).front(), pawn);
+  VERIFY_EQUALS(board.getFigures(Figure::BLACK, Figure::KNIGHT).front(), knight);
+  VERIFY_EQUALS(board.getKing(Figure::BLACK), board.getFigure(Field("e8")));
+  TEST_END
+}
+
+TEST_PROCEDURE(BoardDetectsInsufficientMaterial) {
+  TEST_START
+  Board board;
+  VERIFY_TRUE(board.setBoardFromFEN("8/8/3k4/8/8/2K5/8/8 w - - 0 1"));
+  VERIFY_TRUE(board.isInsufficientMaterial());
+  VERIFY_TRUE(board.setBoardFromFEN("8/8/3k4/8/8/2K5/5N2/8 w - - 0 1"));
+  VERIFY_TRUE(board.isInsufficientMaterial());
+  VERIFY_TRUE(board.setBoardFromFEN("8/8/3k4/8/3b4/2K5/8/8 w - - 0 1"));
+  VERIFY_TRUE(board.isInsufficientMaterial());
+  VERIFY_EQUALS(board.getGameStatus(Figure::WHITE), Board::GameStatus::DRAW);
+  VERIFY_TRUE(board.setBoardFromFEN("8/8/3k4/8/3b4/2K5/5B2/8 w - - 0 1"));
+  VERIFY_TRUE(board.isInsufficientMaterial());
+  VERIFY_TRUE(board.setBoardFromFEN("8/8/3k4/8/3b4/2K5/4B3/8 w - - 0 1"));
+  VERIFY_FALSE(board.isInsufficientMaterial());
+  VERIFY_TRUE(board.setBoardFromFEN("8/8/3k4/8/3n4/2K5/5N2/8 w - - 0 1"));
+  VERIFY_FALSE(board.isInsufficientMaterial());
+  VERIFY_TRUE(board.setBoardFromFEN("8/8/3k4/8/8/2K5/5P2/8 w - - 0 1"));
+  VERIFY_FALSE(board.isInsufficientMaterial());
+  VERIFY_EQUALS(board.getMaterialKey(),
+                Board::createMaterialKey(Figure::WHITE, Figure::KING) +
+                Board::createMaterialKey(Figure::BLACK, Figure::KING) +
+                Board::createMaterialKey(Figure::WHITE, Figure::PAWN));
+  TEST_END
+}
+
+TEST_PROCEDURE(BoardFieldsHoldFigureCodes) {
+  TEST_START
+  Board board;
+  board.setStandardBoard();
+  const auto& fields = board.getFields();
+  VERIFY_EQUALS(sizeof(fields), 64ul);
+  VERIFY_EQUALS(fields[Field::E][Field::ONE], Figure::createCode(Figure::KING, Figure::WHITE));
+  VERIFY_EQUALS(fields[Field::D][Field::EIGHT], Figure::createCode(Figure::QUEEN, Figure::BLACK));
+  VERIFY_EQUALS(fields[Field::E][Field::FOUR], Figure::NoFigure);
+  board.makeMove(Field("e2"), Field("e4"));
+  VERIFY_EQUALS(fields[Field::E][Field::TWO], Figure::NoFigure);
+  VERIFY_EQUALS(Figure::codeToType(fields[Field::E][Field::FOUR]), Figure::PAWN);
+  VERIFY_EQUALS(Figure::codeToColor(fields[Field::E][Field::FOUR]), Figure::WHITE);
+  VerifyFigure(board, "e4", Figure::PAWN, Figure::WHITE);
+  TEST_END
+}
+
+TEST_PROCEDURE(BoardLegalMoveGeneratorProducesAllLegalMoves) {
+  TEST_START
+  Board board;
+  board.setStandardBoard();
+  Board::LegalMoveGenerator generator(board, Figure::WHITE);
+  Figure::Move move;
+  size_t moves_count = 0;
+  while (generator.next(move) == true) {
+    ++moves_count;
+  }
+  VERIFY_EQUALS(moves_count, 20ul);
+  VERIFY_FALSE(generator.next(move));
+
+  VERIFY_TRUE(board.setBoardFromFEN("4k3/8/8/8/8/8/3r4/R3K3 w Q - 0 1"));
+  Board::LegalMoveGenerator king_generator(board, board.getKing(Figure::WHITE));
+  moves_count = 0;
+  while (king_generator.next(move) == true) {
+    VERIFY_EQUALS(move.old_field, Field("e1"));
+    VERIFY_TRUE(move.new_field == Field("f1") || move.new_field == Field("d2"));
+    ++moves_count;
+  }
+  VERIFY_EQUALS(moves_count, 2ul);
+  VERIFY_TRUE(board.isMoveValid(Field("e1"), Field("d2")));
+  VERIFY_FALSE(board.isMoveValid(Field("e1"), Field("c1")));
+  VERIFY_FALSE(board.isMoveValid(Field("e1"), Field("e2")));
+  TEST_END
+}
+
+TEST_PROCEDURE(BoardGivesCheckWorksCorrectly) {
+  TEST_START
+  Board board;
+  VERIFY_TRUE(board.setBoardFromFEN("4k3/8/8/8/8/8/4B3/3RK2R w K - 0 1"));
+  Board::CheckInfo info = board.calculateCheckInfo(Figure::WHITE);
+  VERIFY_TRUE(board.givesCheck(Figure::Move("d1d8"), info));
+  VERIFY_FALSE(board.givesCheck(Figure::Move("d1d7"), info));
+  VERIFY_TRUE(board.givesCheck(Figure::Move("e2b5"), info));
+  VERIFY_FALSE(board.givesCheck(Figure::Move("h1h2"), info));
+
+  VERIFY_TRUE(board.setBoardFromFEN("4k3/8/8/8/8/4N3/8/4R1K1 w - - 0 1"));
+  info = board.calculateCheckInfo(Figure::WHITE);
+  VERIFY_TRUE(board.givesCheck(Figure::Move("e3c2"), info));
+  VERIFY_TRUE(board.givesCheck(Figure::Move("e3d5"), info));
+  VERIFY_FALSE(board.givesCheck(Figure::Move("g1f2"), info));
+
+  VERIFY_TRUE(board.setBoardFromFEN("5k2/8/8/8/8/8/8/4K2R w K - 0 1"));
+  info = board.calculateCheckInfo(Figure::WHITE);
+  VERIFY_TRUE(board.givesCheck(Figure::Move(Field("e1"), Field("g1"), Figure::Move::Castling::K), info));
+  VERIFY_FALSE(board.givesCheck(Figure::Move("h1h2"), info));
+  TEST_END
+}
+
+TEST_PROCEDURE(BoardCalculatesMovesForAllPawnsAtOnce) {
+  TEST_START
+  Board board;
+  board.setStandardBoard();
+  std::vector<Figure::Move> moves;
+  board.calculatePawnMoves(Figure::WHITE, board.getPieces(Figure::WHITE, Figure::PAWN), moves);
+  VERIFY_EQUALS(moves.size(), 16ul);
+
+  VERIFY_TRUE(board.setBoardFromFEN("1n2k3/P7/8/3pP3/8/8/8/4K3 w - d6 0 1"));
+  moves.clear();
+  board.calculatePawnMoves(Figure::WHITE, board.getPieces(Figure::WHITE, Figure::PAWN), moves);
+  VERIFY_EQUALS(moves.size(), 10ul);
+  VERIFY_CONTAINS(moves, Figure::Move("a7b8q"));
+  VERIFY_CONTAINS(moves, Figure::Move("a7a8n"));
+  VERIFY_CONTAINS(moves, Figure::Move("e5d6"));
+  VERIFY_CONTAINS(moves, Figure::Move("e5e6"));
+  TEST_END
+}
+
+TEST_PROCEDURE(BoardAttackMapsAreUpdatedIncrementally) {
+  TEST_START
+  Board board;
+  VERIFY_TRUE(board.setBoardFromFEN("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"));
+  VERIFY_FALSE(board.areAttackMapsEnabled());
+  VERIFY_EQUALS(board.getAttacks(Figure::WHITE), 0ul);
+  board.enableAttackMaps(true);
+  VERIFY_EQUALS(board.getNumberOfAttackers(Figure::WHITE, Field("f5")), 2u);
+  VERIFY_EQUALS(board.getNumberOfAttackers(Figure::BLACK, Field("d5")), 3u);
+  {
+    auto wrapper = board.makeReversibleMove(Figure::Move("e5f7"));
+    auto wrapper2 = board.makeReversibleMove(Figure::Move(Field("e8"), Field("g8"), Figure::Move::Castling::k));
+    Board copy(board);
+    copy.enableAttackMaps(true);
+    VERIFY_EQUALS(board.getAttacks(Figure::WHITE), copy.getAttacks(Figure::WHITE));
+    VERIFY_EQUALS(board.getAttacks(Figure::BLACK), copy.getAttacks(Figure::BLACK));
+    VERIFY_EQUALS(board.getNumberOfAttackers(Figure::BLACK, Field("f7")), 3u);
+  }
+  Board copy(board);
+  copy.enableAttackMaps(true);
+  VERIFY_EQUALS(board.getAttacks(Figure::WHITE), copy.getAttacks(Figure::WHITE));
+  VERIFY_EQUALS(board.getAttacks(Figure::BLACK), copy.getAttacks(Figure::BLACK));
+  TEST_END
+}
+
+TEST_PROCEDURE(BoardValidatesAndMakesTrustedMoves) {
+  TEST_START
+  Board board;
+  board.setStandardBoard();
+  Figure::Move move("e2e5");
+  VERIFY_FALSE(board.validateMove(move));
+  move = Figure::Move("e7e5");
+  VERIFY_FALSE(board.validateMove(move));
+  Board reference;
+  reference.setStandardBoard();
+  for (const char* m: {"e2e4", "e7e5", "g1f3", "b8c6", "f1c4", "g8f6", "e1g1", "f6e4"}) {
+    move = Figure::Move(m);
+    VERIFY_TRUE(board.validateMove(move));
+    board.makeTrustedMove(move);
+    reference.makeMove(Figure::Move(m).old_field, Figure::Move(m).new_field);
+  }
+  VERIFY_STRINGS_EQUAL(board.createFEN().c_str(), reference.createFEN().c_str());
+  VERIFY_STRINGS_EQUAL(board.createFEN().c_str(),
+                       "r1bqkb1r/pppp1ppp/2n5/4p3/2B1n3/5N2/PPPP1PPP/RNBQ1RK1 w kq - 0 5");
+
+  VERIFY_TRUE(board.setBoardFromFEN("4k3/1P6/8/8/8/8/8/4K2R w K - 0 1"));
+  move = Figure::Move("b7b8");
+  VERIFY_FALSE(board.validateMove(move));
+  move = Figure::Move("b7b8n");
+  VERIFY_TRUE(board.validateMove(move));
+  move = Figure::Move("e1g1");
+  VERIFY_TRUE(board.validateMove(move));
+  VERIFY_TRUE(move.castling == Figure::Move::Castling::K);
+  TEST_END
+}
+
+TEST_PROCEDURE(BoardIsMoveValidHandlesSpecialMoves) {
+  TEST_START
+  Board board;
+  VERIFY_TRUE(board.setBoardFromFEN("r3k2r/1P6/8/3pP3/8/8/8/R3K2R w KQkq d6 0 1"));
+  VERIFY_TRUE(board.isMoveValid(Field("e5"), Field("d6")));
+  VERIFY_FALSE(board.isMoveValid(Field("e5"), Field("f6")));
+  VERIFY_TRUE(board.isMoveValid(Field("b7"), Field("a8")));
+  VERIFY_TRUE(board.isMoveValid(Field("b7"), Field("b8")));
+  VERIFY_TRUE(board.isMoveValid(Field("e1"), Field("g1")));
+  VERIFY_TRUE(board.isMoveValid(Field("e1"), Field("c1")));
+  VERIFY_FALSE(board.isMoveValid(Field("e1"), Field("e3")));
+  VERIFY_FALSE(board.isMoveValid(Field("a1"), Field("b2")));
+  VERIFY_TRUE(board.isMoveValid(Field("h1"), Field("h8")));
+  VERIFY_TRUE(board.setBoardFromFEN("r3k2r/8/8/8/8/8/5r2/R3K2R w KQkq - 0 1"));
+  VERIFY_FALSE(board.isMoveValid(Field("e1"), Field("g1")));
+  VERIFY_TRUE(board.isMoveValid(Field("e1"), Field("c1")));
+  TEST_END
+}
+
+TEST_PROCEDURE(BoardHashIdentifiesPositions) {
+  TEST_START
+  Board board;
+  board.setStandardBoard();
+  Board transposed;
+  transposed.setStandardBoard();
+  const uint64_t initial_hash = board.getHash();
+  for (const char* m: {"g1f3", "g8f6", "b1c3", "b8c6"}) {
+    board.makeMove(Figure::Move(m).old_field, Figure::Move(m).new_field);
+  }
+  for (const char* m: {"b1c3", "b8c6", "g1f3", "g8f6"}) {
+    transposed.makeMove(Figure::Move(m).old_field, Figure::Move(m).new_field);
+  }
+  VERIFY_EQUALS(board.getHash(), transposed.getHash());
+  Board from_fen;
+  VERIFY_TRUE(from_fen.setBoardFromFEN(board.createFEN()));
+  VERIFY_EQUALS(board.getHash(), from_fen.getHash());
+  VERIFY_TRUE(board.getHash() != initial_hash);
+  {
+    auto wrapper = board.makeReversibleMove(Figure::Move("e2e4"));
+    VERIFY_TRUE(board.getHash() != transposed.getHash());
+  }
+  VERIFY_EQUALS(board.getHash(), transposed.getHash());
+  from_fen.setSideToMove(Figure::BLACK);
+  VERIFY_TRUE(board.getHash() != from_fen.getHash());
+  VERIFY_TRUE(from_fen.setBoardFromFEN("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w Kkq - 0 1"));
+  VERIFY_TRUE(from_fen.getHash() != initial_hash);
+  TEST_END
+}
+
+TEST_PROCEDURE(BoardMakesAndUndoesNullMoves) {
+  TEST_START
+  Board board;
+  VERIFY_TRUE(board.setBoardFromFEN("4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1"));
+  const uint64_t hash = board.getHash();
+  {
+    auto wrapper = board.makeNullMove();
+    VERIFY_EQUALS(board.getSideToMove(), Figure::BLACK);
+    VERIFY_EQUALS(board.getEnPassantFile(), Field::NONE);
+    VERIFY_TRUE(board.getHash() != hash);
+    Board expected;
+    VERIFY_TRUE(expected.setBoardFromFEN("4k3/8/8/3pP3/8/8/8/4K3 b - - 0 1"));
+    VERIFY_EQUALS(board.getHash(), expected.getHash());
+  }
+  VERIFY_EQUALS(board.getSideToMove(), Figure::WHITE);
+  VERIFY_EQUALS(board.getEnPassantFile(), Field::D);
+  VERIFY_EQUALS(board.getHash(), hash);
+  TEST_END
+}
+
+TEST_PROCEDURE(BoardCalculatesStaticExchange) {
+  TEST_START
+  Board board;
+  // Undefended pawn.
+  VERIFY_TRUE(board.setBoardFromFEN("1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1"));
+  VERIFY_EQUALS(board.calculateStaticExchange(Figure::Move("e1e5")), PAWN_VALUE);
+  // Pawn defended by a knight, the rook is lost for a pawn and a knight.
+  VERIFY_TRUE(board.setBoardFromFEN("1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1"));
+  VERIFY_EQUALS(board.calculateStaticExchange(Figure::Move("d3e5")), PAWN_VALUE - KNIGHT_VALUE);
+  // The queen behind the rook recaptures through the x-ray.
+  VERIFY_TRUE(board.setBoardFromFEN("4k3/4r3/8/4p3/8/8/4R3/4QK2 w - - 0 1"));
+  VERIFY_EQUALS(board.calculateStaticExchange(Figure::Move("e2e5")), PAWN_VALUE);
+  // The king can't take back a defended figure.
+  VERIFY_TRUE(board.setBoardFromFEN("8/8/3k4/4p3/3P4/8/7B/4K3 w - - 0 1"));
+  VERIFY_EQUALS(board.calculateStaticExchange(Figure::Move("d4e5")), PAWN_VALUE);
+  VERIFY_TRUE(board.setBoardFromFEN("4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1"));
+  VERIFY_EQUALS(board.calculateStaticExchange(Figure::Move("e5d6")), PAWN_VALUE);
+  TEST_END
+}
+
 } // unnamed namespace
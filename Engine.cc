@@ -1,19 +1,20 @@
 #include "Engine.h"
 
-#include <condition_variable>
 #include <cstdlib>
 #include <chrono>
+#include <cmath>
 #include <ctime>
+#include <algorithm>
 #include <functional>
 #include <iostream>
-#include <mutex>
 #include <stdio.h>
-#include <thread>
 #include <unistd.h>
+#include <unordered_map>
 
 #include "Board.h"
 #include "Figure.h"
 #include "Logger.h"
+#include "MateSolver.h"
 #include "utils/SocketLog.h"
 #include "utils/Utils.h"
 
@@ -30,6 +31,109 @@ constexpr int MoveForeclosingCastlingModificator = -50;
 // Position modificators
 constexpr int KnightAtTheBorderModificator = -25;
 
+// Endgame modificators
+constexpr int WeakKingAwayFromCenterModificator = 10;
+constexpr int KingsDistanceModificator = -4;
+
+// Drives the lone king to the border and brings the stronger king closer.
+int evaluateMatingEndgame(const Board& board, Figure::Color strong_side) {
+  const Field weak_king = board.getKing(!strong_side)->getPosition();
+  const Field strong_king = board.getKing(strong_side)->getPosition();
+  const int distance_from_center = std::max(3 - weak_king.letter, weak_king.letter - 4) +
+                                   std::max(3 - weak_king.number, weak_king.number - 4);
+  const int kings_distance = std::abs(weak_king.letter - strong_king.letter) +
+                             std::abs(weak_king.number - strong_king.number);
+  int result = WeakKingAwayFromCenterModificator * distance_from_center +
+               KingsDistanceModificator * kings_distance;
+  return strong_side == Figure::WHITE ? result : -result;
+}
+
+// Captures which can't raise alpha even with this margin are not searched
+// in quiescence.
+constexpr int DeltaMargin = 200;
+
+constexpr int FigureValues[] = {PAWN_VALUE, KNIGHT_VALUE, BISHOP_VALUE, ROOK_VALUE, QUEEN_VALUE, KING_VALUE};
+
+// Move ordering scores
+constexpr int TranspositionMoveScore = 3000000;
+constexpr int CaptureScore = 2000000;
+constexpr int KillerScore = 1000000;
+constexpr int MaxHistoryScore = KillerScore / 2;
+
+// Positions with only pawns and the king are prone to zugzwang.
+bool hasNonPawnMaterial(const Board& board, Figure::Color color) {
+  return (board.getPieces(color) & ~board.getPieces(color, Figure::PAWN) & ~board.getPieces(color, Figure::KING)) != 0;
+}
+
+bool isQuietMove(const Figure::Move& move) {
+  return move.figure_beaten == false && move.pawn_promotion == Figure::PAWN;
+}
+
+// Late move reductions grow with the logarithms of the depth and the index
+// of the move, the first moves are never reduced.
+constexpr unsigned MinReducedMoveIndex = 3;
+constexpr unsigned MinReducedDepth = 3;
+constexpr size_t ReductionsTableSize = 64;
+
+const auto g_late_move_reductions = [] {
+  std::array<std::array<unsigned, ReductionsTableSize>, ReductionsTableSize> table{};
+  for (size_t depth = 1; depth < ReductionsTableSize; ++depth) {
+    for (size_t index = 1; index < ReductionsTableSize; ++index) {
+      table[depth][index] = static_cast<unsigned>(0.75 + std::log(depth) * std::log(index) / 2.25);
+    }
+  }
+  return table;
+}();
+
+// Only a capture by a figure worth more than its victim can lose material,
+// the others don't need the static exchange evaluation.
+bool canCaptureLoseMaterial(const Board& board, const Figure::Move& move) {
+  if (move.figure_beaten == false || move.pawn_promotion != Figure::PAWN) {
+    return false;
+  }
+  const auto& fields = board.getFields();
+  const uint8_t victim = fields[move.new_field.letter][move.new_field.number];
+  const uint8_t attacker = fields[move.old_field.letter][move.old_field.number];
+  const int victim_value = victim != Figure::NoFigure ? FigureValues[Figure::codeToType(victim)] : PAWN_VALUE;
+  return FigureValues[Figure::codeToType(attacker)] > victim_value;
+}
+
+// Most valuable victim first, the least valuable attacker breaks ties. En
+// passant has no figure on the target field, the victim is a pawn. Captures
+// losing material are tried after all quiet moves, the smallest loss first.
+int calculateCaptureScore(const Board& board, const Figure::Move& move) {
+  if (canCaptureLoseMaterial(board, move) == true) {
+    const int exchange = board.calculateStaticExchange(move);
+    if (exchange < 0) {
+      return exchange;
+    }
+  }
+  const auto& fields = board.getFields();
+  const uint8_t victim = fields[move.new_field.letter][move.new_field.number];
+  const uint8_t attacker = fields[move.old_field.letter][move.old_field.number];
+  const int victim_type = victim != Figure::NoFigure ? Figure::codeToType(victim) : Figure::PAWN;
+  int score = CaptureScore + victim_type * 16 - Figure::codeToType(attacker);
+  if (move.pawn_promotion == Figure::QUEEN) {
+    score += Figure::QUEEN * 16;
+  }
+  return score;
+}
+
+constexpr uint64_t BareKings = Board::createMaterialKey(Figure::WHITE, Figure::KING) +
+                               Board::createMaterialKey(Figure::BLACK, Figure::KING);
+
+// Specialized endgame evaluations indexed by Board::getMaterialKey().
+const std::unordered_map<uint64_t, int(*)(const Board&)> g_endgame_evaluators = {
+  {BareKings + Board::createMaterialKey(Figure::WHITE, Figure::QUEEN),
+   [](const Board& board) { return evaluateMatingEndgame(board, Figure::WHITE); }},
+  {BareKings + Board::createMaterialKey(Figure::BLACK, Figure::QUEEN),
+   [](const Board& board) { return evaluateMatingEndgame(board, Figure::BLACK); }},
+  {BareKings + Board::createMaterialKey(Figure::WHITE, Figure::ROOK),
+   [](const Board& board) { return evaluateMatingEndgame(board, Figure::WHITE); }},
+  {BareKings + Board::createMaterialKey(Figure::BLACK, Figure::ROOK),
+   [](const Board& board) { return evaluateMatingEndgame(board, Figure::BLACK); }}
+};
+
 };
 
 
@@ -37,48 +141,19 @@ Engine::Engine(
     Board& board,
     unsigned max_number_of_threads)
   : Engine(board) {
-  max_number_of_threads_ = max_number_of_threads;
+  setNumberOfThreads(max_number_of_threads);
 }
 
 Engine::Engine(Board& board) : board_(board) {
-  srand(static_cast<unsigned int>(clock()));
+  thread_pool_.resize(max_number_of_threads_ - 1);
   Logger::getLogger().alertOnMemoryConsumption(
       max_memory_consumption_,
       std::bind(&Engine::onMaxMemoryConsumptionExceeded, this, std::placeholders::_1));
 }
 
-int Engine::generateRandomValue(int max) const {
-  return rand() % (max + 1);
-}
-
-Engine::BorderValues Engine::findBorderValues(const std::vector<Engine::Move>& moves) const {
-  BorderValues result;
-
-  for (auto& move: moves) {
-    if (move.moves_to_mate == 0 && move.value_cp > result.the_biggest_value) {
-      result.the_biggest_value = move.value_cp;
-    }
-    if (move.moves_to_mate == 0 && move.value_cp < result.the_smallest_value) {
-      result.the_smallest_value = move.value_cp;
-    }
-    if (move.moves_to_mate == 0) {
-      result.zero_mate_value_exists = true;
-      continue;
-    }
-    if (move.moves_to_mate > 0 && move.moves_to_mate < result.the_smallest_positive_mate_value) {
-      result.the_smallest_positive_mate_value = move.moves_to_mate;
-    }
-    if (move.moves_to_mate < result.the_smallest_mate_value) {
-      result.the_smallest_mate_value = move.moves_to_mate;
-    }
-    if (move.moves_to_mate < 0 && move.moves_to_mate > result.the_biggest_negative_mate_value) {
-      result.the_biggest_negative_mate_value = move.moves_to_mate;
-    }
-    if (move.moves_to_mate > result.the_biggest_mate_value) {
-      result.the_biggest_mate_value = move.moves_to_mate;
-    }
-  }
-  return result;
+void Engine::setNumberOfThreads(unsigned number_of_threads) {
+  max_number_of_threads_ = std::max(number_of_threads, 1u);
+  thread_pool_.resize(max_number_of_threads_ - 1);
 }
 
 void Engine::onTimerExpired() {
@@ -101,66 +176,47 @@ Figure::Move Engine::makeMove(unsigned time_for_move, unsigned search_depth) {
 
 Engine::SearchInfo Engine::startSearch(unsigned time_for_move, unsigned search_depth) {
   end_calculations_ = false;
+  search_finished_ = false;
   auto start_time = std::chrono::steady_clock::now();
   if (time_for_move > 0) {
     LogWithEndLine(Logger::LogSection::ENGINE_TIMER, "Starting timer");
     timer_.start(time_for_move, std::bind(&Engine::onTimerExpired, this));
   }
+  const size_t table_size = static_cast<size_t>(max_memory_consumption_) * 1024u / 4u;
+  if (transposition_table_.getSizeInBytes() * 2 <= table_size || transposition_table_.getSizeInBytes() > table_size) {
+    transposition_table_.resize(table_size);
+  }
+  transposition_table_.newSearch();
+
   Figure::Color color = board_.getSideToMove();
   Board::GameStatus status = board_.getGameStatus(color);
   if (status != Board::GameStatus::NONE) {
     throw Board::BadBoardStatusException(&board_);
   }
 
-  std::vector<Move> moves;
-  auto figures_moves = board_.calculateMovesForFigures(color);
-  nodes_evaluated_ = figures_moves.size();
-  for (auto& move: figures_moves) {
-    moves.push_back(Move(move, nullptr));
-  }
-  for (unsigned depth = 1; depth < search_depth && end_calculations_ == false; ++depth) {
-    nodes_evaluated_ = 0u;
-    LogWithEndLine(Logger::LogSection::ENGINE_MOVE_SEARCHES, "Starting calculating depth ", depth + 1);
-    for (Move& move: moves) {
-      std::unique_lock<std::mutex> ul(number_of_threads_working_mutex_);
-      number_of_threads_working_cv_.wait(
-          ul, [this] { return number_of_threads_working_ < max_number_of_threads_; });
-      std::thread t(&Engine::generateTreeMain, this, std::ref(move));
-      t.detach();
-      ++number_of_threads_working_;
-      LogWithEndLine(Logger::LogSection::ENGINE_THREADS, "Number of working threads: ", number_of_threads_working_);
-    }
-    // Wait for all threads to finish moves evaluation
-    std::unique_lock<std::mutex> ul(number_of_threads_working_mutex_);
-    number_of_threads_working_cv_.wait(ul, [this] { return number_of_threads_working_ == 0; });
-    LogWithEndLine(Logger::LogSection::ENGINE_MOVE_SEARCHES, "Finished calculating depth ", depth + 1);
+  // Lazy SMP: all threads search the same position and share their results
+  // through the transposition table.
+  SearchInfo info;
+  nodes_evaluated_ = 0u;
+  // With split points the workers wait for work shared by the main thread.
+  const size_t lazy_helpers =
+      parallel_search_ == ParallelSearch::LAZY_SMP ? thread_pool_.getNumberOfThreads() : 0u;
+  for (size_t thread_id = 1; thread_id <= lazy_helpers; ++thread_id) {
+    thread_pool_.addTask([this, thread_id, search_depth] {
+      searchMain(thread_id, std::max(search_depth, 1u), nullptr);
+    });
   }
+  LogWithEndLine(Logger::LogSection::ENGINE_THREADS, "Number of helper threads: ", lazy_helpers);
+  searchMain(0, std::max(search_depth, 1u), &info);
+  search_finished_ = true;
+  thread_pool_.waitForAllTasks();
   timer_.stop();
-
-  SearchInfo info;
   info.nodes = nodes_evaluated_;
-  std::function<void(std::vector<Move>&, Figure::Color)> lambda;
-  lambda = [this, &info, &lambda](std::vector<Move>& moves, Figure::Color color) -> void {
-    ++info.depth;
-    Move* the_best_move = lookForTheBestMove(moves, color);
-    info.best_line.push_back(the_best_move->move);
-    if (info.depth == 1) {
-      info.score_cp = the_best_move->value_cp;
-      info.score_mate = the_best_move->moves_to_mate / 2;
-    }
-    if (the_best_move->moves.empty() == false) {
-      auto wrapper = board_.makeReversibleMove(the_best_move->move);
-      lambda(the_best_move->moves, !color);
-    }
-  };
-  lambda(moves, color);
-
-  if (color == Figure::BLACK) {
-    info.score_cp = -info.score_cp;
-    info.score_mate = -info.score_mate;
-  }
 
-  if (info.score_mate != 0) {
+  if (isMateValue(info.score_cp) == true) {
+    const int plies = MateValue - std::abs(info.score_cp);
+    info.score_mate = info.score_cp > 0 ? (plies + 1) / 2 : -(plies / 2);
+    info.score_cp = 0;
     LogWithEndLine(Logger::LogSection::ENGINE_MATES, "=== Found mate in ", info.score_mate, " ===");
   }
 
@@ -177,88 +233,60 @@ Engine::SearchInfo Engine::startSearch(unsigned time_for_move, unsigned search_d
   return info;
 }
 
-std::pair<int, int> Engine::evaluateBorderValues(Engine::BorderValues values, Figure::Color color) const {
-  int moves_to_mate = 0;
-  int the_best_value = color == Figure::WHITE ? values.the_biggest_value : values.the_smallest_value;
-  if (color == Figure::WHITE) {
-    if (values.the_smallest_positive_mate_value != BorderValue) {
-      moves_to_mate = values.the_smallest_positive_mate_value;
-    } else if (values.zero_mate_value_exists == true) {
-      moves_to_mate = 0;
-    } else {
-      moves_to_mate = values.the_smallest_mate_value;
-    }
-  } else {
-    if (values.the_biggest_negative_mate_value != -BorderValue) {
-      moves_to_mate = values.the_biggest_negative_mate_value;
-    } else if (values.zero_mate_value_exists == true) {
-      moves_to_mate = 0;
-    } else {
-      moves_to_mate = values.the_biggest_mate_value;
-    }
+Engine::SearchInfo Engine::startMateSearch(unsigned time_for_move, unsigned moves_to_mate) {
+  end_calculations_ = false;
+  auto start_time = std::chrono::steady_clock::now();
+  if (time_for_move > 0) {
+    LogWithEndLine(Logger::LogSection::ENGINE_TIMER, "Starting timer");
+    timer_.start(time_for_move, std::bind(&Engine::onTimerExpired, this));
   }
-  BoardAssert(board_, moves_to_mate != BorderValue && moves_to_mate != -BorderValue);
-  return std::make_pair(the_best_value, moves_to_mate);
-}
-
-Engine::Move* Engine::lookForTheBestMove(std::vector<Engine::Move>& moves, Figure::Color color) const {
-  // Iterate through all moves and look for mate and for best value.
-  // Also look for possible opponent's mate.
-  auto border_values = findBorderValues(moves);
-  std::pair<int, int> evaluation = evaluateBorderValues(border_values, color);
-  int the_best_value = evaluation.first;
-  int moves_to_mate = evaluation.second;
-
-  // Collect all best moves.
-  std::vector<Move*> the_best_moves;
-  for (auto& move: moves) {
-    if (moves_to_mate != 0) {
-      if (move.moves_to_mate == moves_to_mate) {
-        the_best_moves.push_back(&move);
-      }
-    } else if (move.moves_to_mate == 0 && move.value_cp == the_best_value) {
-      the_best_moves.push_back(&move);
-    }
+  Figure::Color color = board_.getSideToMove();
+  Board::GameStatus status = board_.getGameStatus(color);
+  if (status != Board::GameStatus::NONE) {
+    throw Board::BadBoardStatusException(&board_);
   }
 
-  // Check which moves from the ones with the best value is the best in one move.
-  std::vector<Move*> the_best_direct_moves;
-  int the_best_direct_move_value = color == Figure::WHITE ? -BorderValue : BorderValue;
-  for (auto* move: the_best_moves) {
-    if (moves_to_mate != 0) {
-      the_best_direct_moves.push_back(move);
-    } else {
-      evaluateBoardForLastNode(board_, *move);
-      if ((color == Figure::WHITE && move->value_cp > the_best_direct_move_value) ||
-          (color == Figure::BLACK && move->value_cp < the_best_direct_move_value)) {
-        the_best_direct_moves.clear();
-        the_best_direct_move_value = move->value_cp;
-      }
-      if ((color == Figure::WHITE && move->value_cp >= the_best_direct_move_value) ||
-          (color == Figure::BLACK && move->value_cp <= the_best_direct_move_value)) {
-        the_best_direct_moves.push_back(move);
-      }
-    }
+  SearchInfo info;
+  Board board = board_;
+  // The tree of the solver gets the same share of memory as the
+  // transposition table.
+  MateSolver solver(board, end_calculations_, static_cast<size_t>(max_memory_consumption_) * 1024u / 4u);
+  const bool found = solver.solve(moves_to_mate, info.best_line);
+  timer_.stop();
+  auto time_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - start_time).count();
+  if (found == false && end_calculations_ == true) {
+    // Stopped or out of time, a single iteration is never interrupted and
+    // gives a move at once.
+    LogWithEndLine(Logger::LogSection::ENGINE_MATES, "Mate search interrupted");
+    auto fallback = startSearch(0u, 1u);
+    end_calculations_ = true;
+    return fallback;
+  }
+  if (found == false) {
+    LogWithEndLine(Logger::LogSection::ENGINE_MATES, "No mate in ", moves_to_mate, " found");
+    const unsigned time_left = time_for_move > time_elapsed ? time_for_move - time_elapsed : 1u;
+    return startSearch(time_for_move > 0 ? time_left : 0u, DefaultSearchDepth);
   }
-  BoardAssert(board_, the_best_direct_moves.size() > 0);
-  // Choose randomly move from the best direct moves.
-  Move* my_move = the_best_direct_moves[generateRandomValue(the_best_direct_moves.size() - 1)];
-  return my_move;
+  info.depth = static_cast<unsigned>(info.best_line.size());
+  info.nodes = solver.getNumberOfNodes();
+  info.score_mate = static_cast<int>(info.best_line.size() + 1) / 2;
+  info.time = time_elapsed;
+  LogWithEndLine(Logger::LogSection::ENGINE_MATES, "=== Found mate in ", info.score_mate, " ===");
+  return info;
 }
 
-int Engine::calculateMoveModificator(Board& board, const Move& move) const {
+int Engine::calculateMoveModificator(Board& board, Figure::Color color, const Figure::Move& move) const {
   int result = 0;
-  if (move.move.castling != Figure::Move::Castling::LAST) {
+  if (move.castling != Figure::Move::Castling::LAST) {
     result += CastlingModificator;
   }
-  if (move.move.is_check == true) {
+  if (move.is_check == true) {
     result += CheckModificator;
   }
-  const Figure* figure = board.getFigure(move.move.old_field);
-  Figure::Color color = figure->getColor();
-  if (move.move.castling == Figure::Move::Castling::LAST &&
+  if (move.castling == Figure::Move::Castling::LAST &&
       board.canKingCastle(color) == true) {
-    auto wrapper = board.makeReversibleMove(move.move);
+    auto wrapper = board.makeReversibleMove(move);
     if (board.canKingCastle(color) == false) {
       result += MoveForeclosingCastlingModificator;
     }
@@ -279,121 +307,640 @@ int Engine::calculatePositionValue(const Board& board) const {
       result += color == Figure::WHITE ? KnightAtTheBorderModificator : -KnightAtTheBorderModificator;
     }
   }
+  auto evaluator = g_endgame_evaluators.find(board.getMaterialKey());
+  if (evaluator != g_endgame_evaluators.end()) {
+    result += evaluator->second(board);
+  }
   return result;
 }
 
-void Engine::evaluateBoardForLastNode(
-    Board& board, Engine::Move& current_move) const {
-  Figure::Color color = board.getFigure(current_move.move.old_field)->getColor();
-  int move_modificator = calculateMoveModificator(board, current_move);
-  auto wrapper = board.makeReversibleMove(current_move.move);
-  current_move.value_cp = calculatePositionValue(board);
-  if (color == Figure::WHITE) {
-    current_move.value_cp += move_modificator;
+int Engine::scoreToTransposition(int score, unsigned ply) {
+  if (isMateValue(score) == false) {
+    return score;
+  }
+  return score > 0 ? score + static_cast<int>(ply) : score - static_cast<int>(ply);
+}
+
+int Engine::scoreFromTransposition(int score, unsigned ply) {
+  if (isMateValue(score) == false) {
+    return score;
+  }
+  return score > 0 ? score - static_cast<int>(ply) : score + static_cast<int>(ply);
+}
+
+template<Figure::Color Us>
+int Engine::evaluate(const Board& board) const {
+  const int value = calculatePositionValue(board);
+  return Us == Figure::WHITE ? value : -value;
+}
+
+void Engine::searchMain(size_t thread_id, unsigned max_depth, SearchInfo* info) {
+  Board board = board_;
+  SearchContext context;
+  context.thread_id = thread_id;
+  if (board.getSideToMove() == Figure::WHITE) {
+    iterativeDeepening<Figure::WHITE>(board, max_depth, context, info);
   } else {
-    current_move.value_cp -= move_modificator;
+    iterativeDeepening<Figure::BLACK>(board, max_depth, context, info);
+  }
+  nodes_evaluated_ += context.nodes;
+}
+
+template<Figure::Color Us>
+void Engine::iterativeDeepening(Board& board, unsigned max_depth, SearchContext& context, SearchInfo* info) {
+  std::vector<RootMove> root_moves;
+  for (auto& move: board.calculateMovesForFigures(Us)) {
+    RootMove root_move;
+    root_move.move = move;
+    root_moves.push_back(root_move);
+  }
+
+  int previous_score = 0;
+  for (unsigned depth = 1; depth <= max_depth; ++depth) {
+    // Every other helper runs one ply ahead, so the threads don't all
+    // search the same nodes at the same time.
+    const unsigned searched_depth = depth + (context.thread_id % 2 == 1 ? 1 : 0);
+    context.can_stop = context.thread_id != 0 || depth > 1;
+    if (shouldStop(context) == true) {
+      break;
+    }
+    if (context.thread_id == 0) {
+      LogWithEndLine(Logger::LogSection::ENGINE_MOVE_SEARCHES, "Starting calculating depth ", depth);
+    }
+
+    // Aspiration window around the previous score, widened on every fail.
+    int delta = AspirationWindow;
+    int alpha = -BorderValue;
+    int beta = BorderValue;
+    if (depth >= MinAspirationDepth && isMateValue(previous_score) == false) {
+      alpha = std::max(previous_score - delta, -BorderValue);
+      beta = std::min(previous_score + delta, BorderValue);
+    }
+    int score = 0;
+    size_t best_index = root_moves.size();
+    while (true) {
+      score = searchRoot<Us>(board, root_moves, searched_depth, alpha, beta, best_index, context);
+      if (shouldStop(context) == true) {
+        break;
+      }
+      // A mate score is far away from any window, the side it fails on is
+      // opened at once.
+      if (score <= alpha) {
+        alpha = isMateValue(score) == true ? -BorderValue : std::max(alpha - delta, -BorderValue);
+      } else if (score >= beta) {
+        beta = isMateValue(score) == true ? BorderValue : std::min(beta + delta, BorderValue);
+      } else {
+        break;
+      }
+      delta *= 2;
+    }
+
+    if (shouldStop(context) == true) {
+      // The best move of the previous iteration is searched first, so a move
+      // which raised alpha of the interrupted iteration is at least as good.
+      if (info != nullptr && best_index < root_moves.size()) {
+        LogWithEndLine(Logger::LogSection::ENGINE_MOVE_SEARCHES, "Using partial result of depth ", depth);
+        info->score_cp = root_moves[best_index].score;
+        info->best_line = root_moves[best_index].line;
+      }
+      break;
+    }
+    previous_score = score;
+    if (info != nullptr) {
+      LogWithEndLine(Logger::LogSection::ENGINE_MOVE_SEARCHES, "Finished calculating depth ", depth);
+      info->depth = depth;
+      info->score_cp = score;
+      info->best_line = root_moves[0].line;
+    }
   }
+}
 
-  current_move.moves_to_mate = 0;
-  if (board.isKingCheckmated(Figure::WHITE) == true) {
-    current_move.moves_to_mate = -1;
+template<Figure::Color Us>
+int Engine::searchRoot(Board& board, std::vector<RootMove>& root_moves, unsigned depth,
+                       int alpha, int beta, size_t& best_index, SearchContext& context) {
+  ++context.nodes;
+  for (RootMove& root_move: root_moves) {
+    root_move.score = -BorderValue;
+  }
+  best_index = root_moves.size();
+  int best_score = -BorderValue;
+  std::vector<Figure::Move> line;
+  for (size_t i = 0; i < root_moves.size(); ++i) {
+    RootMove& root_move = root_moves[i];
+    const int score = searchMoveWithPVS<Us>(board, root_move.move, i, depth, alpha, beta, 0, false, line, context);
+    if (shouldStop(context) == true) {
+      return best_score;
+    }
+    best_score = std::max(best_score, score);
+    // Scores of moves failing low are only bounds, they keep the order.
+    if (score > alpha) {
+      alpha = score;
+      best_index = i;
+      root_move.score = score;
+      root_move.line.clear();
+      root_move.line.push_back(root_move.move);
+      root_move.line.insert(root_move.line.end(), line.begin(), line.end());
+      if (score >= beta) {
+        break;
+      }
+    }
   }
-  if (board.isKingCheckmated(Figure::BLACK) == true) {
-    current_move.moves_to_mate = 1;
+  // The best move goes first in the next search.
+  std::stable_sort(root_moves.begin(), root_moves.end(),
+                   [](const RootMove& a, const RootMove& b) { return a.score > b.score; });
+  best_index = best_index < root_moves.size() ? 0 : best_index;
+  return best_score;
+}
+
+template<Figure::Color Us>
+int Engine::search(Board& board, unsigned depth, int alpha, int beta, unsigned ply,
+                   std::vector<Figure::Move>& line, SearchContext& context) {
+  ++context.nodes;
+  line.clear();
+  const bool after_null_move = context.after_null_move;
+  context.after_null_move = false;
+  if (board.isInsufficientMaterial() == true || board.getHalfMoveClock() >= 50) {
+    return 0;
+  }
+  if (depth == 0) {
+    return quiescence<Us>(board, alpha, beta, ply, context);
+  }
+
+  const uint64_t hash = board.getHash();
+  TranspositionTable::Entry entry;
+  const bool entry_found = transposition_table_.probe(hash, entry);
+  if (entry_found == true && entry.depth >= depth) {
+    const int score = scoreFromTransposition(entry.score, ply);
+    if (entry.bound == TranspositionTable::Bound::EXACT ||
+        (entry.bound == TranspositionTable::Bound::LOWER && score >= beta) ||
+        (entry.bound == TranspositionTable::Bound::UPPER && score <= alpha)) {
+      return score;
+    }
   }
-  if (current_move.moves_to_mate != 0 && Logger::shouldLog(Logger::LogSection::ENGINE_MATES)) {
-    Log(Logger::LogSection::ENGINE_MATES, SocketLog::lock, "Found mate: ");
-    std::function<void(const Engine::Move&)> lambda;
-    lambda = [this, &lambda](const Engine::Move& move) -> void {
-      if (move.parent != nullptr) {
-        lambda(*move.parent);
+
+  const bool in_check = board.isKingChecked(Us);
+  const int static_score = in_check == true ? -BorderValue : evaluate<Us>(board);
+  // Pruning near the leaves, only in zero window nodes which are not in check.
+  const bool can_prune = in_check == false && beta - alpha == 1 && depth <= MaxPruningDepth &&
+                         isMateValue(alpha) == false && isMateValue(beta) == false;
+  if (can_prune == true) {
+    // Reverse futility: even after losing the margin the score is above beta.
+    const int reverse_futility_score = static_score - pruning_margins_.reverse_futility * static_cast<int>(depth);
+    if (reverse_futility_score >= beta) {
+      return reverse_futility_score;
+    }
+    // Razoring: far below alpha only captures can help, so verify that
+    // with the quiescence search.
+    if (static_score + pruning_margins_.razoring * static_cast<int>(depth) <= alpha) {
+      const int score = quiescence<Us>(board, alpha, beta, ply, context);
+      if (score <= alpha || depth == 1) {
+        return score;
       }
-      Log(Logger::LogSection::ENGINE_MATES, move.move, " ");
-    };
-    lambda(current_move);
-    Log(Logger::LogSection::ENGINE_MATES, SocketLog::endl);
+    }
+  }
+  // Quiet moves can't bring a futile node up to alpha.
+  const bool futile = can_prune == true &&
+                      static_score + pruning_margins_.futility * static_cast<int>(depth) <= alpha;
+
+  if (depth >= NullMoveMinDepth && in_check == false && after_null_move == false &&
+      context.verifying_null_move == false && isMateValue(beta) == false &&
+      hasNonPawnMaterial(board, Us) == true && static_score >= beta) {
+    const int score = searchNullMove<Us>(board, depth, beta, ply, context);
+    if (shouldStop(context) == true) {
+      return 0;
+    }
+    if (score >= beta) {
+      return score;
+    }
   }
+
+  std::vector<Figure::Move> moves = board.calculateMovesForFigures(Us);
+  if (moves.empty() == true) {
+    return in_check == true ? -MateValue + static_cast<int>(ply) : 0;
+  }
+  orderMoves(board, moves, entry_found == true ? &entry : nullptr, ply, context);
+
+  const int original_alpha = alpha;
+  int best_score = -BorderValue;
+  size_t best_move = moves.size();
+  std::vector<Figure::Move> child_line;
+  for (size_t i = 0; i < moves.size(); ++i) {
+    if (i == 1 && parallel_search_ == ParallelSearch::SPLIT_POINTS && depth >= MinSplitDepth &&
+        thread_pool_.getNumberOfIdleThreads() > 0) {
+      splitSearch<Us>(board, moves, i, depth, ply, in_check, futile, alpha, beta, best_score, best_move, line,
+                      context);
+      if (shouldStop(context) == true) {
+        return 0;
+      }
+      break;
+    }
+    if (futile == true && i > 0 && isQuietMove(moves[i]) == true && moves[i].is_check == false) {
+      continue;
+    }
+    const int score = searchMoveWithPVS<Us>(board, moves[i], i, depth, alpha, beta, ply, in_check == false,
+                                            child_line, context);
+    if (shouldStop(context) == true) {
+      return 0;
+    }
+    if (score > best_score) {
+      best_score = score;
+      best_move = i;
+      if (score > alpha) {
+        alpha = score;
+        line.clear();
+        line.push_back(moves[i]);
+        line.insert(line.end(), child_line.begin(), child_line.end());
+        if (score >= beta) {
+          if (isQuietMove(moves[i]) == true) {
+            updateQuietMoveStatistics(Us, moves[i], depth, ply, context);
+          }
+          break;
+        }
+      }
+    }
+  }
+
+  TranspositionTable::Bound bound = TranspositionTable::Bound::EXACT;
+  if (best_score >= beta) {
+    bound = TranspositionTable::Bound::LOWER;
+  } else if (best_score <= original_alpha) {
+    // All moves failed low, none of them is known to be the best.
+    bound = TranspositionTable::Bound::UPPER;
+    best_move = moves.size();
+  }
+  transposition_table_.store(hash, depth, bound, scoreToTransposition(best_score, ply),
+                             best_move < moves.size() ? &moves[best_move] : nullptr);
+  return best_score;
 }
 
-void Engine::evaluateBoard(Board& board, Engine::Move& current_move) const {
-  if (current_move.moves.empty() == true) {
-    evaluateBoardForLastNode(board, current_move);
-    return;
+// Searches captures, promotions and mates only, so the position is evaluated
+// once it's quiet. In check all evasions are searched.
+template<Figure::Color Us>
+int Engine::quiescence(Board& board, int alpha, int beta, unsigned ply, SearchContext& context) {
+  ++context.nodes;
+  if (board.isInsufficientMaterial() == true) {
+    return 0;
+  }
+  if (ply >= MaxPly) {
+    return evaluate<Us>(board);
+  }
+  if (board.isKingChecked(Us) == true) {
+    return quiescenceEvasions<Us>(board, alpha, beta, ply, context);
+  }
+  // The side to move isn't forced to capture.
+  const int stand_pat = evaluate<Us>(board);
+  if (stand_pat >= beta) {
+    return stand_pat;
+  }
+  alpha = std::max(alpha, stand_pat);
+
+  // Captures and promotions are generated pseudo legal, only the ones
+  // surviving the pruning below are made and tested for legality.
+  std::vector<Figure::Move> moves;
+  board.calculateCaptures(Us, moves);
+  orderMoves(board, moves, nullptr, ply, context);
+  const Board::CheckInfo check_info = board.calculateCheckInfo(Us);
+  // Checks which are not searched, only tested for a mate.
+  std::vector<Figure::Move> checks;
+
+  int best_score = stand_pat;
+  for (const Figure::Move& move: moves) {
+    const auto& fields = board.getFields();
+    const uint8_t victim = fields[move.new_field.letter][move.new_field.number];
+    const int gain = victim != Figure::NoFigure ? FigureValues[Figure::codeToType(victim)] : PAWN_VALUE;
+    // Captures which can't raise alpha and captures losing material are
+    // not searched.
+    if ((move.pawn_promotion == Figure::PAWN && stand_pat + gain + DeltaMargin <= alpha) ||
+        (canCaptureLoseMaterial(board, move) == true && board.calculateStaticExchange(move) < 0)) {
+      if (board.givesCheck(move, check_info) == true) {
+        checks.push_back(move);
+      }
+      continue;
+    }
+    int score = 0;
+    {
+      auto wrapper = board.makeReversibleMove(move);
+      if (board.isKingChecked(Us) == true) {
+        continue;
+      }
+      score = -quiescence<!Us>(board, -beta, -alpha, ply + 1, context);
+    }
+    if (shouldStop(context) == true) {
+      return 0;
+    }
+    if (score > best_score) {
+      best_score = score;
+      if (score > alpha) {
+        alpha = score;
+        if (score >= beta) {
+          return best_score;
+        }
+      }
+    }
+  }
+
+  // Quiet checks and pruned capturing checks are not searched any deeper,
+  // but a mate among them would be missed by the stand pat.
+  const int mate_score = MateValue - static_cast<int>(ply) - 1;
+  if (mate_score > alpha) {
+    board.calculateQuietChecks(Us, check_info, checks);
+    for (const Figure::Move& move: checks) {
+      auto wrapper = board.makeReversibleMove(move);
+      if (board.isKingChecked(Us) == false && board.isKingCheckmated(!Us) == true) {
+        return mate_score;
+      }
+    }
   }
+  return best_score;
+}
 
-  current_move.value_cp = 0;
-  int move_modificator = calculateMoveModificator(board, current_move);
-  auto border_values = findBorderValues(current_move.moves);
-  Figure::Color color = board.getFigure(current_move.move.old_field)->getColor();
-  if (color == Figure::WHITE) {
-    current_move.value_cp = border_values.the_biggest_value;
-    current_move.value_cp += move_modificator;
-  } else {
-    current_move.value_cp = border_values.the_smallest_value;
-    current_move.value_cp -= move_modificator;
-  }
-  current_move.moves_to_mate = BorderValue;
-  if (color == Figure::BLACK) {
-    if (border_values.the_smallest_positive_mate_value < BorderValue) {
-      current_move.moves_to_mate = border_values.the_smallest_positive_mate_value + 1;
-    } else if (border_values.zero_mate_value_exists == true) {
-      current_move.moves_to_mate = 0;
+template<Figure::Color Us>
+int Engine::quiescenceEvasions(Board& board, int alpha, int beta, unsigned ply, SearchContext& context) {
+  std::vector<Figure::Move> moves = board.calculateMovesForFigures(Us);
+  if (moves.empty() == true) {
+    return -MateValue + static_cast<int>(ply);
+  }
+  orderMoves(board, moves, nullptr, ply, context);
+
+  int best_score = -BorderValue;
+  for (const Figure::Move& move: moves) {
+    int score = 0;
+    if (move.is_mate == true) {
+      score = MateValue - static_cast<int>(ply) - 1;
     } else {
-      BoardAssert(board, border_values.the_smallest_mate_value < 0);
-      current_move.moves_to_mate = border_values.the_smallest_mate_value - 1;
+      auto wrapper = board.makeReversibleMove(move);
+      score = -quiescence<!Us>(board, -beta, -alpha, ply + 1, context);
     }
-  } else {
-    if (border_values.the_biggest_negative_mate_value > -BorderValue) {
-      current_move.moves_to_mate = border_values.the_biggest_negative_mate_value - 1;
-    } else if (border_values.zero_mate_value_exists == true) {
-      current_move.moves_to_mate = 0;
+    if (shouldStop(context) == true) {
+      return 0;
+    }
+    if (score > best_score) {
+      best_score = score;
+      if (score > alpha) {
+        alpha = score;
+        if (score >= beta) {
+          break;
+        }
+      }
+    }
+  }
+  return best_score;
+}
+
+void Engine::orderMoves(const Board& board, std::vector<Figure::Move>& moves, const TranspositionTable::Entry* entry,
+                        unsigned ply, const SearchContext& context) const {
+  const Figure::Color color = board.getSideToMove();
+  std::vector<int> scores(moves.size());
+  for (size_t i = 0; i < moves.size(); ++i) {
+    const Figure::Move& move = moves[i];
+    if (entry != nullptr && entry->isSameMove(move) == true) {
+      scores[i] = TranspositionMoveScore;
+    } else if (isQuietMove(move) == false) {
+      scores[i] = calculateCaptureScore(board, move);
+    } else if (ply < MaxPly && move == context.killers[ply][0]) {
+      scores[i] = KillerScore + 1;
+    } else if (ply < MaxPly && move == context.killers[ply][1]) {
+      scores[i] = KillerScore;
     } else {
-      BoardAssert(board, border_values.the_biggest_mate_value > 0);
-      current_move.moves_to_mate = border_values.the_biggest_mate_value + 1;
+      scores[i] = context.history[color][bitboard::toSquare(move.old_field)][bitboard::toSquare(move.new_field)];
     }
   }
+  // Move lists are short, a stable insertion sort keeps generation order
+  // for equal scores.
+  for (size_t i = 1; i < moves.size(); ++i) {
+    const Figure::Move move = moves[i];
+    const int score = scores[i];
+    size_t j = i;
+    for (; j > 0 && scores[j - 1] < score; --j) {
+      moves[j] = moves[j - 1];
+      scores[j] = scores[j - 1];
+    }
+    moves[j] = move;
+    scores[j] = score;
+  }
+}
 
-  BoardAssert(board, (current_move.value_cp != BorderValue && current_move.value_cp != -BorderValue) ||
-                     current_move.moves_to_mate != BorderValue);
+void Engine::updateQuietMoveStatistics(Figure::Color color, const Figure::Move& move, unsigned depth,
+                                       unsigned ply, SearchContext& context) const {
+  if (ply < MaxPly && move != context.killers[ply][0]) {
+    context.killers[ply][1] = context.killers[ply][0];
+    context.killers[ply][0] = move;
+  }
+  int& history = context.history[color][bitboard::toSquare(move.old_field)][bitboard::toSquare(move.new_field)];
+  history += static_cast<int>(depth * depth);
+  // Halving all entries keeps their proportions and stays below killers.
+  if (history > MaxHistoryScore) {
+    for (auto& from: context.history[color]) {
+      for (auto& value: from) {
+        value /= 2;
+      }
+    }
+  }
 }
 
-void Engine::generateTreeMain(Engine::Move& move) {
-  Board copy = board_;
-  Figure::Color color = copy.getFigure(move.move.old_field)->getColor();
-  generateTree(copy, color, move);
-  onThreadFinished();
+// If passing the move still fails high on a reduced depth, a real move
+// would do even better. That's false in zugzwang, so deep results are
+// verified by a reduced search without null moves.
+template<Figure::Color Us>
+int Engine::searchNullMove(Board& board, unsigned depth, int beta, unsigned ply, SearchContext& context) {
+  const unsigned reduction = depth > 6 ? 3 : 2;
+  const unsigned reduced_depth = depth > reduction + 1 ? depth - reduction - 1 : 0;
+  std::vector<Figure::Move> line;
+  int score = 0;
+  {
+    auto wrapper = board.makeNullMove();
+    context.after_null_move = true;
+    score = -search<!Us>(board, reduced_depth, -beta, -beta + 1, ply + 1, line, context);
+    context.after_null_move = false;
+  }
+  if (score < beta || shouldStop(context) == true) {
+    return score;
+  }
+  // Unproven mates are not returned.
+  if (isMateValue(score) == true) {
+    score = beta;
+  }
+  if (depth < NullMoveVerificationDepth) {
+    return score;
+  }
+  context.verifying_null_move = true;
+  const int verified_score = search<Us>(board, depth - reduction, beta - 1, beta, ply, line, context);
+  context.verifying_null_move = false;
+  return verified_score >= beta ? score : verified_score;
 }
 
-void Engine::generateTree(Board& board, Figure::Color color, Engine::Move& move) {
-  if (move.moves.empty() == false) {
-    auto wrapper = board.makeReversibleMove(move.move);
-    nodes_evaluated_ += move.moves.size();
-    for (auto& m: move.moves) {
-      if (end_calculations_ == true) {
-        break;
-      }
-      generateTree(board, !color, m);
+template<Figure::Color Us>
+int Engine::searchMove(Board& board, const Figure::Move& move, unsigned depth, int alpha, int beta,
+                       unsigned ply, std::vector<Figure::Move>& line, SearchContext& context) {
+  line.clear();
+  if (move.is_mate == true) {
+    return MateValue - static_cast<int>(ply) - 1;
+  }
+  // The modificator is added to the child's score, so its window is
+  // shifted by the same amount.
+  const int modificator = calculateMoveModificator(board, Us, move);
+  auto wrapper = board.makeReversibleMove(move);
+  int score = -search<!Us>(board, depth - 1, modificator - beta, modificator - alpha, ply + 1, line, context);
+  if (isMateValue(score) == false) {
+    score += modificator;
+  }
+  return score;
+}
+
+// Principal variation search: the first move gets the full window, the
+// other ones are expected to fail low and get a zero window first. Late
+// quiet moves are searched on a reduced depth, every fail high is searched
+// again without reduction and with the full window.
+template<Figure::Color Us>
+int Engine::searchMoveWithPVS(Board& board, const Figure::Move& move, size_t index, unsigned depth,
+                              int alpha, int beta, unsigned ply, bool can_reduce,
+                              std::vector<Figure::Move>& line, SearchContext& context) {
+  if (index == 0) {
+    return searchMove<Us>(board, move, depth, alpha, beta, ply, line, context);
+  }
+  unsigned reduction = 0;
+  if (late_move_reductions_ == true && can_reduce == true &&
+      depth >= MinReducedDepth && index >= MinReducedMoveIndex &&
+      isQuietMove(move) == true && move.is_check == false &&
+      (ply >= MaxPly || (move != context.killers[ply][0] && move != context.killers[ply][1]))) {
+    reduction = g_late_move_reductions[std::min<size_t>(depth, ReductionsTableSize - 1)]
+                                      [std::min<size_t>(index, ReductionsTableSize - 1)];
+    reduction = std::min(reduction, depth - 2);
+  }
+  int score = searchMove<Us>(board, move, depth - reduction, alpha, alpha + 1, ply, line, context);
+  if (score > alpha && reduction > 0) {
+    score = searchMove<Us>(board, move, depth, alpha, alpha + 1, ply, line, context);
+  }
+  // In zero window nodes failing high is already a beta cutoff.
+  if (beta - alpha > 1 && score > alpha && score < beta) {
+    score = searchMove<Us>(board, move, depth, alpha, beta, ply, line, context);
+  }
+  return score;
+}
+
+template<Figure::Color Us>
+void Engine::splitSearch(Board& board, const std::vector<Figure::Move>& moves, size_t first_move,
+                         unsigned depth, unsigned ply, bool in_check, bool futile, int& alpha, int beta,
+                         int& best_score, size_t& best_move, std::vector<Figure::Move>& line, SearchContext& context) {
+  auto split_point = std::make_shared<SplitPoint>(board);
+  split_point->moves = moves;
+  split_point->parent = context.split_point;
+  split_point->depth = depth;
+  split_point->ply = ply;
+  split_point->thread_id = context.thread_id;
+  split_point->can_stop = context.can_stop;
+  split_point->in_check = in_check;
+  split_point->futile = futile;
+  split_point->beta = beta;
+  split_point->master_context = context;
+  split_point->next_move = first_move;
+  split_point->alpha = alpha;
+  split_point->best_score = best_score;
+  split_point->best_move = best_move;
+  split_point->line = line;
+
+  const size_t helpers = std::min(thread_pool_.getNumberOfIdleThreads(), moves.size() - first_move - 1);
+  for (size_t i = 0; i < helpers; ++i) {
+    thread_pool_.addTask([this, split_point] { helpSplitPoint(split_point); });
+  }
+
+  // The master searches the moves as well and waits only for the helpers
+  // which are still busy when no move is left.
+  const SplitPoint* parent = context.split_point;
+  context.split_point = split_point.get();
+  searchSplitPointMoves<Us>(board, *split_point, context);
+  context.split_point = parent;
+
+  std::unique_lock<std::mutex> ul(split_point->mutex);
+  split_point->finished = true;
+  split_point->helpers_finished_cv.wait(ul, [&split_point] { return split_point->helpers == 0; });
+  context.nodes += split_point->nodes;
+  alpha = split_point->alpha;
+  best_score = split_point->best_score;
+  best_move = split_point->best_move;
+  line = split_point->line;
+}
+
+void Engine::helpSplitPoint(const std::shared_ptr<SplitPoint>& split_point) {
+  {
+    std::lock_guard<std::mutex> lg(split_point->mutex);
+    if (split_point->finished == true || split_point->next_move == split_point->moves.size()) {
+      return;
     }
+    ++split_point->helpers;
+  }
+  Board board = split_point->board;
+  SearchContext context = split_point->master_context;
+  context.nodes = 0u;
+  context.thread_id = split_point->thread_id;
+  context.can_stop = split_point->can_stop;
+  context.split_point = split_point.get();
+  if (board.getSideToMove() == Figure::WHITE) {
+    searchSplitPointMoves<Figure::WHITE>(board, *split_point, context);
   } else {
-    Board::GameStatus status = board.getGameStatus(color);
-    if (status == Board::GameStatus::NONE) {
-      auto wrapper = board.makeReversibleMove(move.move);
-      std::vector<Figure::Move> figures_moves = board.calculateMovesForFigures(!color);
-      nodes_evaluated_ += figures_moves.size();
-      for (Figure::Move& figure_move: figures_moves) {
-        Move new_move(figure_move, &move);
-        evaluateBoardForLastNode(board, new_move);
-        move.moves.push_back(new_move);
+    searchSplitPointMoves<Figure::BLACK>(board, *split_point, context);
+  }
+  std::lock_guard<std::mutex> lg(split_point->mutex);
+  split_point->nodes += context.nodes;
+  --split_point->helpers;
+  split_point->helpers_finished_cv.notify_one();
+}
+
+template<Figure::Color Us>
+void Engine::searchSplitPointMoves(Board& board, SplitPoint& split_point, SearchContext& context) {
+  std::vector<Figure::Move> child_line;
+  while (true) {
+    size_t index = 0;
+    int alpha = 0;
+    {
+      std::lock_guard<std::mutex> lg(split_point.mutex);
+      if (split_point.cutoff == true || split_point.next_move == split_point.moves.size()) {
+        return;
+      }
+      index = split_point.next_move++;
+      alpha = split_point.alpha;
+    }
+    const Figure::Move& move = split_point.moves[index];
+    if (split_point.futile == true && isQuietMove(move) == true && move.is_check == false) {
+      continue;
+    }
+    const int score = searchMoveWithPVS<Us>(board, move, index, split_point.depth, alpha, split_point.beta,
+                                            split_point.ply, split_point.in_check == false, child_line, context);
+    if (shouldStop(context) == true) {
+      return;
+    }
+    std::lock_guard<std::mutex> lg(split_point.mutex);
+    if (score > split_point.best_score) {
+      split_point.best_score = score;
+      split_point.best_move = index;
+      if (score > split_point.alpha) {
+        split_point.alpha = score;
+        split_point.line.clear();
+        split_point.line.push_back(move);
+        split_point.line.insert(split_point.line.end(), child_line.begin(), child_line.end());
+        if (score >= split_point.beta) {
+          split_point.cutoff = true;
+          if (isQuietMove(move) == true) {
+            updateQuietMoveStatistics(Us, move, split_point.depth, split_point.ply, context);
+          }
+        }
       }
     }
   }
-  evaluateBoard(board, move);
 }
 
-void Engine::onThreadFinished() {
-  number_of_threads_working_mutex_.lock();
-  --number_of_threads_working_;
-  LogWithEndLine(Logger::LogSection::ENGINE_THREADS, "Number of working threads: ", number_of_threads_working_);
-  number_of_threads_working_mutex_.unlock();
-  number_of_threads_working_cv_.notify_one();
+bool Engine::shouldStop(const SearchContext& context) const {
+  if (context.can_stop == true &&
+      (end_calculations_ == true || (context.thread_id != 0 && search_finished_ == true))) {
+    return true;
+  }
+  // A beta cutoff found by another thread makes the rest of its split point
+  // useless.
+  for (const SplitPoint* split_point = context.split_point; split_point != nullptr;
+       split_point = split_point->parent) {
+    if (split_point->cutoff == true) {
+      return true;
+    }
+  }
+  return false;
 }
@@ -1,15 +1,20 @@
 #ifndef ENGINE_H
 #define ENGINE_H
 
+#include <array>
+#include <atomic>
 #include <condition_variable>
 #include <exception>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <utility>
 #include <vector>
 
 #include "Board.h"
 #include "Figure.h"
+#include "ThreadPool.h"
+#include "TranspositionTable.h"
 #include "utils/Timer.h"
 
 
@@ -24,11 +29,36 @@ class Engine {
     std::vector<Figure::Move> best_line;
   };
 
+  // Margins of pruning near the leaves, in centipawns per ply of the
+  // remaining depth.
+  struct PruningMargins {
+    int futility{150};
+    int reverse_futility{150};
+    int razoring{350};
+  };
+
+  enum class ParallelSearch {
+    // Every thread searches the whole tree, they share results through the
+    // transposition table.
+    LAZY_SMP,
+    // Young Brothers Wait: once the first move of a node is searched, the
+    // other ones are shared with idle threads.
+    SPLIT_POINTS
+  };
+
   Engine(Board& board, unsigned max_number_of_threads);
   Engine(Board& board);
-  void setNumberOfThreads(unsigned number_of_threads) { max_number_of_threads_ = number_of_threads; }
+  // The calling thread searches too, the pool gets one thread less.
+  void setNumberOfThreads(unsigned number_of_threads);
   void setMaxMemoryConsumption(unsigned m) { max_memory_consumption_ = m; }
+  void setParallelSearch(ParallelSearch parallel_search) { parallel_search_ = parallel_search; }
+  void setLateMoveReductions(bool enable) { late_move_reductions_ = enable; }
+  void setPruningMargins(const PruningMargins& margins) { pruning_margins_ = margins; }
+  const PruningMargins& getPruningMargins() const { return pruning_margins_; }
   SearchInfo startSearch(unsigned time_for_move, unsigned search_depth);
+  // Proof-number search for a mate in at most the given number of moves,
+  // the regular search picks the move when there is none.
+  SearchInfo startMateSearch(unsigned time_for_move, unsigned moves_to_mate);
   Figure::Move makeMove(unsigned time_for_move = 0u, unsigned search_depth = DefaultSearchDepth);
   void endCalculations() { end_calculations_ = true; }
 
@@ -37,54 +67,139 @@ class Engine {
   static const unsigned DefaultSearchDepth = 4;
   static const unsigned DefaultNumberOfThreads = 5;
   static const unsigned DefaultMaxMemoryConsumption = 2000000u;  // kB. ~2GB
-
-  struct Move {
-    Move() {}
-    Move(const Move& other) {
-      // Created to avoid unnecessary coping of field moves
-      move = other.move;
-      value_cp = other.value_cp;
-      moves_to_mate = other.moves_to_mate;
-      is_draw = other.is_draw;
-      parent = other.parent;
-    }
-    Move(Figure::Move fmove, Engine::Move* p) : move(fmove), parent(p) {}
-    Move(Figure::Move fmove, int v, int m, bool d) : move(fmove), value_cp(v), moves_to_mate(m), is_draw(d) {}
-
+  // Smaller subtrees are not worth copying the board for other threads.
+  static const unsigned MinSplitDepth = 3;
+  // Null move pruning is tried from this depth on, its results are
+  // verified by a reduced search from NullMoveVerificationDepth on.
+  static const unsigned NullMoveMinDepth = 3;
+  static const unsigned NullMoveVerificationDepth = 6;
+  // Futility pruning, reverse futility and razoring work up to this depth.
+  static const unsigned MaxPruningDepth = 3;
+  // Killer moves are kept for that many plies from the root.
+  static const unsigned MaxPly = 128;
+  // Half width of the first root window, shallow iterations use a full one.
+  static const int AspirationWindow = 50;
+  static const unsigned MinAspirationDepth = 3;
+
+  struct RootMove {
     Figure::Move move;
-    int value_cp{0};
-    int moves_to_mate{0};
-    bool is_draw{false};
-    std::vector<Engine::Move> moves;
-    Engine::Move* parent{nullptr};
+    int score{-BorderValue};
+    std::vector<Figure::Move> line;
   };
 
-  struct BorderValues {
-    int the_smallest_value{BorderValue};
-    int the_biggest_value{-BorderValue};
-    int the_smallest_mate_value{BorderValue};
-    int the_biggest_mate_value{-BorderValue};
-    int the_smallest_positive_mate_value{BorderValue};
-    int the_biggest_negative_mate_value{-BorderValue};
-    bool zero_mate_value_exists{false};
+  struct SplitPoint;
+
+ public:
+  // public for testing purposes
+  // Mate scores are MateValue minus the number of plies to the mate.
+  static const int MateValue = BorderValue - 1000;
+
+  // Mate scores are stored relative to the node, not to the root.
+  static int scoreToTransposition(int score, unsigned ply);
+  static int scoreFromTransposition(int score, unsigned ply);
+
+  // State of one search thread.
+  struct SearchContext {
+    unsigned nodes{0u};
+    // Thread 0 is the main one and reports results. Helpers only fill the
+    // transposition table and are stopped when the main thread finishes.
+    size_t thread_id{0u};
+    // The innermost split point the thread is searching below.
+    const SplitPoint* split_point{nullptr};
+    // The first iteration of the main thread is never interrupted, so there
+    // is always a move.
+    bool can_stop{false};
+    // Set for the child of a null move, two null moves in a row prove nothing.
+    bool after_null_move{false};
+    // Null moves are not tried below a verification search.
+    bool verifying_null_move{false};
+    // Two latest quiet moves which caused a beta cutoff at every ply.
+    std::array<std::array<Figure::Move, 2>, MaxPly> killers;
+    // Butterfly history of quiet moves causing beta cutoffs, indexed by
+    // color, origin and target square.
+    std::array<std::array<std::array<int, bitboard::NumberOfSquares>, bitboard::NumberOfSquares>, 2> history{};
   };
 
-  BorderValues findBorderValues(const std::vector<Move>& moves) const;
+  // Transposition table move, winning captures by MVV-LVA, killers, quiet
+  // moves by history and losing captures last.
+  void orderMoves(const Board& board, std::vector<Figure::Move>& moves, const TranspositionTable::Entry* entry,
+                  unsigned ply, const SearchContext& context) const;
+  void updateQuietMoveStatistics(Figure::Color color, const Figure::Move& move, unsigned depth, unsigned ply,
+                                 SearchContext& context) const;
 
-  void evaluateBoardForLastNode(Board& board, Move& move) const;
-  void evaluateBoard(Board& board, Move& move) const;
-  std::pair<int, int> evaluateBorderValues(BorderValues values, Figure::Color color) const;
-  int calculateMoveModificator(Board& board, const Move& move) const;
-  int calculatePositionValue(const Board& board) const;
+ private:
+  // Node whose remaining moves are searched by several threads.
+  struct SplitPoint {
+    SplitPoint(const Board& b) : board(b) {}
+
+    // Position of the node, every helper searches on its own copy.
+    const Board board;
+    std::vector<Figure::Move> moves;
+    const SplitPoint* parent{nullptr};
+    unsigned depth{0u};
+    unsigned ply{0u};
+    size_t thread_id{0u};
+    bool can_stop{false};
+    bool in_check{false};
+    // Quiet moves are pruned as in the serial search.
+    bool futile{false};
+    int beta{0};
+    // Context of the master at the split, helpers start with its killers,
+    // history and null move state.
+    SearchContext master_context;
+
+    // Guarded by mutex.
+    std::mutex mutex;
+    std::condition_variable helpers_finished_cv;
+    size_t next_move{0u};
+    int alpha{0};
+    int best_score{0};
+    size_t best_move{0u};
+    std::vector<Figure::Move> line;
+    unsigned helpers{0u};
+    unsigned nodes{0u};
+    // No helper may join after the master ran out of moves.
+    bool finished{false};
+    // Stops all threads below the node.
+    std::atomic<bool> cutoff{false};
+  };
 
-  void generateTreeMain(Engine::Move& move);
-  void generateTree(Board& board, Figure::Color color, Engine::Move& move);
 
-  Move* lookForTheBestMove(std::vector<Engine::Move>& moves, Figure::Color color) const;
-  
-  void onThreadFinished();
+  static bool isMateValue(int value) { return value > MateValue - 1000 || value < -MateValue + 1000; }
 
-  int generateRandomValue(int max) const;
+  int calculateMoveModificator(Board& board, Figure::Color color, const Figure::Move& move) const;
+  int calculatePositionValue(const Board& board) const;
+  template<Figure::Color Us> int evaluate(const Board& board) const;
+
+  void searchMain(size_t thread_id, unsigned max_depth, SearchInfo* info);
+  template<Figure::Color Us>
+  void iterativeDeepening(Board& board, unsigned max_depth, SearchContext& context, SearchInfo* info);
+  template<Figure::Color Us>
+  int searchRoot(Board& board, std::vector<RootMove>& root_moves, unsigned depth,
+                 int alpha, int beta, size_t& best_index, SearchContext& context);
+  template<Figure::Color Us>
+  int search(Board& board, unsigned depth, int alpha, int beta, unsigned ply,
+             std::vector<Figure::Move>& line, SearchContext& context);
+  template<Figure::Color Us>
+  int quiescence(Board& board, int alpha, int beta, unsigned ply, SearchContext& context);
+  template<Figure::Color Us>
+  int quiescenceEvasions(Board& board, int alpha, int beta, unsigned ply, SearchContext& context);
+  template<Figure::Color Us>
+  int searchNullMove(Board& board, unsigned depth, int beta, unsigned ply, SearchContext& context);
+  template<Figure::Color Us>
+  int searchMove(Board& board, const Figure::Move& move, unsigned depth, int alpha, int beta, unsigned ply,
+                 std::vector<Figure::Move>& line, SearchContext& context);
+  template<Figure::Color Us>
+  int searchMoveWithPVS(Board& board, const Figure::Move& move, size_t index, unsigned depth, int alpha, int beta,
+                        unsigned ply, bool can_reduce, std::vector<Figure::Move>& line, SearchContext& context);
+  template<Figure::Color Us>
+  void splitSearch(Board& board, const std::vector<Figure::Move>& moves, size_t first_move,
+                   unsigned depth, unsigned ply, bool in_check, bool futile, int& alpha, int beta,
+                   int& best_score, size_t& best_move, std::vector<Figure::Move>& line, SearchContext& context);
+  void helpSplitPoint(const std::shared_ptr<SplitPoint>& split_point);
+  template<Figure::Color Us>
+  void searchSplitPointMoves(Board& board, SplitPoint& split_point, SearchContext& context);
+  bool shouldStop(const SearchContext& context) const;
 
   void onTimerExpired();
 
@@ -93,13 +208,20 @@ class Engine {
   Board& board_;
   unsigned max_number_of_threads_{DefaultNumberOfThreads};
   unsigned max_memory_consumption_{DefaultMaxMemoryConsumption};
-  unsigned number_of_threads_working_{0u};
-  std::mutex number_of_threads_working_mutex_;
-  std::condition_variable number_of_threads_working_cv_;
+  ParallelSearch parallel_search_{ParallelSearch::LAZY_SMP};
+  bool late_move_reductions_{true};
+  PruningMargins pruning_margins_;
   int moves_count_{0};
-  unsigned nodes_evaluated_{0u};
+  std::atomic<unsigned> nodes_evaluated_{0u};
+  // Set by the main thread when it's done, stops the helper threads.
+  std::atomic<bool> search_finished_{false};
+  // Shared by all search threads, a quarter of the memory limit.
+  TranspositionTable transposition_table_;
   utils::Timer timer_;
-  bool end_calculations_{false};
+  std::atomic<bool> end_calculations_{false};
+  // Declared last, so the workers are joined before anything they use is
+  // destroyed.
+  ThreadPool thread_pool_;
 };
 
 #endif  // ENGINE_H
@@ -1,6 +1,7 @@
 /* Component tests for class Engine */
 
 #include <cassert>
+#include <chrono>
 #include <exception>
 #include <iostream>
 #include <stdexcept>
@@ -13,6 +14,7 @@
 #include "Field.h"
 #include "Figure.h"
 #include "Logger.h"
+#include "TranspositionTable.h"
 
 
 namespace {
@@ -188,4 +190,250 @@ TEST_PROCEDURE(EngineMovesKnightFromTheBorder) {
   TEST_END
 }
 
+TEST_PROCEDURE(EngineOrdersMoves) {
+  TEST_START
+  Board board;
+  Engine engine(board, 1);
+  board.setBoardFromFEN("r3k3/p7/8/3q4/4P3/2N5/8/R3K3 w - - 0 1");
+  std::vector<Figure::Move> moves = board.calculateMovesForFigures(Figure::WHITE);
+  TranspositionTable::Entry entry;
+  entry.has_move = true;
+  entry.old_field = Field("a1");
+  entry.new_field = Field("b1");
+  Engine::SearchContext context;
+  context.killers[0][0] = Figure::Move("c3b5");
+  context.killers[0][1] = Figure::Move("e1f2");
+  context.history[Figure::WHITE][bitboard::toSquare(Field("c3"))][bitboard::toSquare(Field("e2"))] = 50;
+  engine.orderMoves(board, moves, &entry, 0, context);
+  VERIFY_TRUE(MovesEqual(moves[0], "a1-b1"));
+  // The queen is taken by the least valuable attacker first.
+  VERIFY_TRUE(MovesEqual(moves[1], "e4-d5"));
+  VERIFY_TRUE(MovesEqual(moves[2], "c3-d5"));
+  VERIFY_TRUE(MovesEqual(moves[3], "c3-b5"));
+  VERIFY_TRUE(MovesEqual(moves[4], "e1-f2"));
+  VERIFY_TRUE(MovesEqual(moves[5], "c3-e2"));
+  // The defended pawn costs the rook.
+  VERIFY_TRUE(MovesEqual(moves.back(), "a1-a7"));
+
+  // Cutoffs of quiet moves make them killers and raise their history.
+  engine.updateQuietMoveStatistics(Figure::WHITE, Figure::Move("e4e5"), 3, 0, context);
+  VERIFY_TRUE(context.killers[0][0] == Figure::Move("e4e5"));
+  VERIFY_TRUE(context.killers[0][1] == Figure::Move("c3b5"));
+  VERIFY_TRUE(context.history[Figure::WHITE][bitboard::toSquare(Field("e4"))][bitboard::toSquare(Field("e5"))] > 0);
+  TEST_END
+}
+
+TEST_PROCEDURE(EngineStoresMateScoresRelativeToTheNode) {
+  TEST_START
+  TranspositionTable table;
+  table.resize(1 << 16);
+  // Mate in five plies from the root found at ply three.
+  const int score = Engine::MateValue - 5;
+  table.store(0x77u, 4u, TranspositionTable::Bound::EXACT, Engine::scoreToTransposition(score, 3), nullptr);
+  TranspositionTable::Entry entry;
+  VERIFY_TRUE(table.probe(0x77u, entry));
+  VERIFY_EQUALS(entry.score, Engine::MateValue - 2);
+  // The same position reached at another ply is mated later or sooner.
+  VERIFY_EQUALS(Engine::scoreFromTransposition(entry.score, 3), score);
+  VERIFY_EQUALS(Engine::scoreFromTransposition(entry.score, 7), Engine::MateValue - 9);
+  VERIFY_EQUALS(Engine::scoreFromTransposition(-entry.score, 1), -Engine::MateValue + 3);
+  // Other scores don't depend on the ply.
+  VERIFY_EQUALS(Engine::scoreToTransposition(-250, 6), -250);
+  VERIFY_EQUALS(Engine::scoreFromTransposition(-250, 6), -250);
+  TEST_END
+}
+
+TEST_PROCEDURE(EngineSearchesWithLazySMP) {
+  TEST_START
+  const std::string fens[] = {
+    "8/8/1b6/1k6/3q4/3n4/6PP/R3R2K b - - 0 1",
+    "r5rk/5p1p/5R2/4B3/8/8/7P/7K w - - 0 1"
+  };
+  for (const auto& fen: fens) {
+    // Helpers share their results through the transposition table, the
+    // main thread has to come to the same conclusion as when searching
+    // alone.
+    Board single_board;
+    Engine single_engine(single_board, 1);
+    single_board.setBoardFromFEN(fen);
+    auto single = single_engine.startSearch(0, 6);
+    Board board;
+    Engine engine(board, 4);
+    board.setBoardFromFEN(fen);
+    auto info = engine.startSearch(0, 6);
+    VERIFY_EQUALS(info.depth, 6u);
+    VERIFY_TRUE(info.score_mate > 0);
+    VERIFY_EQUALS(info.score_mate, single.score_mate);
+    VERIFY_TRUE(info.best_line[0] == single.best_line[0]);
+  }
+  TEST_END
+}
+
+TEST_PROCEDURE(EngineSearchesWithSplitPoints) {
+  TEST_START
+  {
+    Board board;
+    Engine engine(board, 4);
+    engine.setParallelSearch(Engine::ParallelSearch::SPLIT_POINTS);
+    board.setBoardFromFEN("8/8/1b6/1k6/3q4/3n4/6PP/R3R2K b - - 0 1");
+    auto info = engine.startSearch(0, 4);
+    VERIFY_EQUALS(info.score_mate, 2);
+    VERIFY_TRUE(MovesEqual(info.best_line[0], "d4-g1"));
+  }
+  {
+    Board board;
+    Engine engine(board, 4);
+    engine.setParallelSearch(Engine::ParallelSearch::SPLIT_POINTS);
+    board.setBoardFromFEN("6k1/5ppp/6b1/3Q3n/1K6/8/8/8 b - - 0 1");
+    auto move = engine.makeMove();
+    VERIFY_TRUE(MovesEqual(move, "h7-h6"));
+  }
+  TEST_END
+}
+
+TEST_PROCEDURE(EngineReportsLastCompletedIterationWhenInterrupted) {
+  TEST_START
+  Board board;
+  Engine engine(board, 4);
+  board.setStandardBoard();
+  auto info = engine.startSearch(100, 1000);
+  VERIFY_TRUE(info.depth >= 1u && info.depth < 1000u);
+  VERIFY_FALSE(info.best_line.empty());
+  VERIFY_TRUE(board.isMoveValid(info.best_line[0].old_field, info.best_line[0].new_field));
+  TEST_END
+}
+
+TEST_PROCEDURE(EngineDoesNotPruneZugzwangsWithNullMoves) {
+  TEST_START
+  {
+    // Kh6 puts black in zugzwang, every move loses material or mates.
+    // Null moves of black refute it unless they are verified.
+    Board board;
+    Engine engine(board, 1);
+    board.setBoardFromFEN("1q1k4/2Rr4/8/2Q3K1/8/8/8/8 w - - 0 1");
+    auto info = engine.startSearch(0, 7);
+    VERIFY_TRUE(MovesEqual(info.best_line[0], "g5-h6"));
+  }
+  {
+    // Only pawns, null moves are not tried. Kc5 leaves black to move in the
+    // trebuchet, which loses the d5 pawn.
+    Board board;
+    Engine engine(board, 1);
+    board.setBoardFromFEN("8/8/2K5/3p4/3Pk3/8/8/8 w - - 0 1");
+    auto info = engine.startSearch(0, 6);
+    VERIFY_TRUE(MovesEqual(info.best_line[0], "c6-c5"));
+    VERIFY_EQUALS(info.score_cp, PAWN_VALUE);
+  }
+  {
+    // In check, the null move would be illegal.
+    Board board;
+    Engine engine(board, 1);
+    board.setBoardFromFEN("4k3/8/8/8/8/8/3q4/R3K3 w - - 0 1");
+    auto info = engine.startSearch(0, 5);
+    VERIFY_TRUE(MovesEqual(info.best_line[0], "e1-d2"));
+  }
+  TEST_END
+}
+
+TEST_PROCEDURE(EngineSearchesCapturesBeyondTheHorizon) {
+  TEST_START
+  Board board;
+  Engine engine(board, 4);
+  board.setBoardFromFEN("4k3/8/4p3/3p4/8/8/8/3QK3 w - - 0 1");
+  auto info = engine.startSearch(0, 1);
+  VERIFY_FALSE(MovesEqual(info.best_line[0], "d1-d5"));
+  VERIFY_TRUE(info.score_cp < QUEEN_VALUE - PAWN_VALUE);
+  TEST_END
+}
+
+TEST_PROCEDURE(EngineReducesLateMovesWithoutChangingTheResult) {
+  TEST_START
+  const std::string fen = "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4";
+  Board reduced_board;
+  Engine reduced_engine(reduced_board, 1);
+  reduced_board.setBoardFromFEN(fen);
+  auto reduced = reduced_engine.startSearch(0, 6);
+  Board full_board;
+  Engine full_engine(full_board, 1);
+  full_engine.setLateMoveReductions(false);
+  full_board.setBoardFromFEN(fen);
+  auto full = full_engine.startSearch(0, 6);
+  VERIFY_TRUE(reduced.nodes < full.nodes);
+  VERIFY_TRUE(reduced.best_line[0] == full.best_line[0]);
+  TEST_END
+}
+
+TEST_PROCEDURE(EnginePrunesWithoutMissingTactics) {
+  TEST_START
+  const std::pair<const char*, const char*> positions[] = {
+    {"2rr3k/pp3pp1/1nnqbN1p/3pN3/2pP4/2P3Q1/PPB4P/R4RK1 w - - 0 1", "g3-g6"},
+    {"5rk1/1ppb3p/p1pb4/6q1/3P1p1r/2P1R2P/PP1BQ1P1/5RKN w - - 0 1", "e3-g3"},
+    {"r1bq2rk/pp3pbp/2p1p1pQ/7P/3P4/2PB1N2/PP3PPR/2KR4 w - - 0 1", "h6-h7"},
+    {"5k2/6pp/p1qN4/1p1p4/3P4/2PKP2Q/PP3r2/3R4 b - - 0 1", "c6-c4"},
+    {"r3k3/8/8/1N6/8/8/8/4K3 w - - 0 1", "b5-c7"}
+  };
+  // The biggest margins accepted over UCI leave hardly anything to prune.
+  Engine::PruningMargins wide_margins;
+  wide_margins.futility = 1000;
+  wide_margins.reverse_futility = 1000;
+  wide_margins.razoring = 2000;
+  unsigned pruned_nodes = 0u;
+  unsigned full_nodes = 0u;
+  for (const auto& position: positions) {
+    Board pruned_board;
+    Engine pruned_engine(pruned_board, 1);
+    pruned_board.setBoardFromFEN(position.first);
+    auto pruned = pruned_engine.startSearch(0, 5);
+    VERIFY_TRUE(MovesEqual(pruned.best_line[0], position.second));
+    Board full_board;
+    Engine full_engine(full_board, 1);
+    full_engine.setPruningMargins(wide_margins);
+    full_board.setBoardFromFEN(position.first);
+    auto full = full_engine.startSearch(0, 5);
+    VERIFY_TRUE(MovesEqual(full.best_line[0], position.second));
+    VERIFY_EQUALS(pruned.score_mate, full.score_mate);
+    pruned_nodes += pruned.nodes;
+    full_nodes += full.nodes;
+  }
+  VERIFY_TRUE(pruned_nodes < full_nodes);
+  TEST_END
+}
+
+TEST_PROCEDURE(EngineSolvesMatesWithProofNumberSearch) {
+  TEST_START
+  {
+    Board board;
+    Engine engine(board, 4);
+    board.setBoardFromFEN("r5rk/5p1p/5R2/4B3/8/8/7P/7K w - - 0 1");
+    auto info = engine.startMateSearch(0, 5);
+    VERIFY_EQUALS(info.score_mate, 3);
+    VERIFY_EQUALS(info.best_line.size(), 5u);
+    VERIFY_TRUE(MovesEqual(info.best_line[0], "f6-a6"));
+    VERIFY_TRUE(MovesEqual(info.best_line[4], "a6-a8"));
+  }
+  {
+    // No mate, the regular search picks the move.
+    Board board;
+    Engine engine(board, 4);
+    board.setBoardFromFEN("5rk1/pp4pp/4p3/2R3Q1/3n4/2q4r/P1P2PPP/5RK1 b - - 1 0");
+    auto info = engine.startMateSearch(0, 2);
+    VERIFY_EQUALS(info.score_mate, 0);
+    VERIFY_FALSE(info.best_line.empty());
+  }
+  {
+    // Endless checks, the solver runs out of time and a move comes at once.
+    Board board;
+    Engine engine(board, 4);
+    board.setBoardFromFEN("6q1/2k5/8/8/8/8/5K2/Q7 w - - 0 1");
+    auto start_time = std::chrono::steady_clock::now();
+    auto info = engine.startMateSearch(100, 20);
+    auto time_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start_time).count();
+    VERIFY_TRUE(time_elapsed < 500);
+    VERIFY_EQUALS(info.score_mate, 0);
+    VERIFY_FALSE(info.best_line.empty());
+  }
+  TEST_END
+}
+
 } // unnamed namespace
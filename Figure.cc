@@ -21,24 +21,24 @@ void addMove(const Board& board,
       false,  // it will be updated later
       false,  // it will be updated later
       Figure::Move::Castling::LAST,
-      board.getFigure(Field(static_cast<Field::Letter>(new_l), static_cast<Field::Number>(new_n))) != nullptr,
+      board.getFields()[new_l][new_n] != Figure::NoFigure,
       promo);
   moves.push_back(move);
 }
 
-void calculateMovesForBishop(std::vector<Figure::Move>& moves, const Board& board, Field field) {
-  const Figure* bishop = board.getFigure(field);
+void calculateMovesForBishop(std::vector<Figure::Move>& moves, const Board& board, const Figure* bishop) {
+  const Field field = bishop->getPosition();
   Figure::Color my_color = bishop->getColor();
+  const auto& fields = board.getFields();
 
   int l = field.letter - 1;
   int n = field.number - 1;
   while (l >= Field::A && n >= Field::ONE) {
-    const Figure* figure = board.getFigure(Field(static_cast<Field::Letter>(l),
-                                                 static_cast<Field::Number>(n)));
-    if (!figure || (figure && figure->getColor() != my_color)) {
+    const uint8_t code = fields[l][n];
+    if (code == Figure::NoFigure || Figure::codeToColor(code) != my_color) {
       addMove(board, moves, bishop, l, n);
     }
-    if (figure != nullptr) {
+    if (code != Figure::NoFigure) {
       break;
     }
     --l, --n;
@@ -47,12 +47,11 @@ void calculateMovesForBishop(std::vector<Figure::Move>& moves, const Board& boar
   l = field.letter - 1;
   n = field.number + 1;
   while (l >= Field::A && n <= Field::EIGHT) {
-    const Figure* figure = board.getFigure(Field(static_cast<Field::Letter>(l),
-                                                 static_cast<Field::Number>(n)));
-    if (!figure || (figure && figure->getColor() != my_color)) {
+    const uint8_t code = fields[l][n];
+    if (code == Figure::NoFigure || Figure::codeToColor(code) != my_color) {
       addMove(board, moves, bishop, l, n);
     }
-    if (figure != nullptr) {
+    if (code != Figure::NoFigure) {
       break;
     }
     --l, ++n;
@@ -61,12 +60,11 @@ void calculateMovesForBishop(std::vector<Figure::Move>& moves, const Board& boar
   l = field.letter + 1;
   n = field.number + 1;
   while (l <= Field::H && n <= Field::EIGHT) {
-    const Figure* figure = board.getFigure(Field(static_cast<Field::Letter>(l),
-                                                 static_cast<Field::Number>(n)));
-    if (!figure || (figure && figure->getColor() != my_color)) {
+    const uint8_t code = fields[l][n];
+    if (code == Figure::NoFigure || Figure::codeToColor(code) != my_color) {
       addMove(board, moves, bishop, l, n);
     }
-    if (figure != nullptr) {
+    if (code != Figure::NoFigure) {
       break;
     }
     ++l, ++n;
@@ -75,31 +73,30 @@ void calculateMovesForBishop(std::vector<Figure::Move>& moves, const Board& boar
   l = field.letter + 1;
   n = field.number - 1;
   while (l <= Field::H && n >= Field::ONE) {
-    const Figure* figure = board.getFigure(Field(static_cast<Field::Letter>(l),
-                                                 static_cast<Field::Number>(n)));
-    if (!figure || (figure && figure->getColor() != my_color)) {
+    const uint8_t code = fields[l][n];
+    if (code == Figure::NoFigure || Figure::codeToColor(code) != my_color) {
       addMove(board, moves, bishop, l, n);
     }
-    if (figure != nullptr) {
+    if (code != Figure::NoFigure) {
       break;
     }
     ++l, --n;
   }
 }
 
-void calculateMovesForRook(std::vector<Figure::Move>& moves, const Board& board, Field field) {
-  const Figure* rook = board.getFigure(field);
+void calculateMovesForRook(std::vector<Figure::Move>& moves, const Board& board, const Figure* rook) {
+  const Field field = rook->getPosition();
   Figure::Color my_color = rook->getColor();
+  const auto& fields = board.getFields();
 
   int l = field.letter - 1;
   int n = field.number;
   while (l >= Field::A) {
-    const Figure* figure = board.getFigure(Field(static_cast<Field::Letter>(l),
-                                                 static_cast<Field::Number>(n)));
-    if (!figure || (figure && figure->getColor() != my_color)) {
+    const uint8_t code = fields[l][n];
+    if (code == Figure::NoFigure || Figure::codeToColor(code) != my_color) {
       addMove(board, moves, rook, l, n);
     }
-    if (figure != nullptr) {
+    if (code != Figure::NoFigure) {
       break;
     }
     --l;
@@ -107,12 +104,11 @@ void calculateMovesForRook(std::vector<Figure::Move>& moves, const Board& board,
 
   l = field.letter + 1;
   while (l <= Field::H) {
-    const Figure* figure = board.getFigure(Field(static_cast<Field::Letter>(l),
-                                                 static_cast<Field::Number>(n)));
-    if (!figure || (figure && figure->getColor() != my_color)) {
+    const uint8_t code = fields[l][n];
+    if (code == Figure::NoFigure || Figure::codeToColor(code) != my_color) {
       addMove(board, moves, rook, l, n);
     }
-    if (figure != nullptr) {
+    if (code != Figure::NoFigure) {
       break;
     }
     ++l;
@@ -121,12 +117,11 @@ void calculateMovesForRook(std::vector<Figure::Move>& moves, const Board& board,
   l = field.letter;
   n = field.number + 1;
   while (n <= Field::EIGHT) {
-    const Figure* figure = board.getFigure(Field(static_cast<Field::Letter>(l),
-                                                 static_cast<Field::Number>(n)));
-    if (!figure || (figure && figure->getColor() != my_color)) {
+    const uint8_t code = fields[l][n];
+    if (code == Figure::NoFigure || Figure::codeToColor(code) != my_color) {
       addMove(board, moves, rook, l, n);
     }
-    if (figure != nullptr) {
+    if (code != Figure::NoFigure) {
       break;
     }
     ++n;
@@ -134,12 +129,11 @@ void calculateMovesForRook(std::vector<Figure::Move>& moves, const Board& board,
 
   n = field.number - 1;
   while (n >= Field::ONE) {
-    const Figure* figure = board.getFigure(Field(static_cast<Field::Letter>(l),
-                                                 static_cast<Field::Number>(n)));
-    if (!figure || (figure && figure->getColor() != my_color)) {
+    const uint8_t code = fields[l][n];
+    if (code == Figure::NoFigure || Figure::codeToColor(code) != my_color) {
       addMove(board, moves, rook, l, n);
     }
-    if (figure != nullptr) {
+    if (code != Figure::NoFigure) {
       break;
     }
     --n;
@@ -186,11 +180,11 @@ Figure::Move::Move(const std::string& move) {
 }
 
 Figure::Move::Castling Figure::Move::isCastling(const Board* board, Field old_field, Field new_field) {
-  const Figure* figure = board->getFigure(old_field);
-  if (figure == nullptr || figure->getType() != Figure::KING) {
+  const uint8_t code = board->getFields()[old_field.letter][old_field.number];
+  if (code == NoFigure || codeToType(code) != Figure::KING) {
     return Figure::Move::Castling::LAST;
   }
-  Color color = figure->getColor();
+  Color color = codeToColor(code);
   Field::Number number = color == Figure::WHITE ? Field::ONE : Field::EIGHT;
   if (old_field != Field(Field::E, number)) {
     return Figure::Move::Castling::LAST;
@@ -205,18 +199,18 @@ Figure::Move::Castling Figure::Move::isCastling(const Board* board, Field old_fi
 }
 
 bool Figure::Move::isPromotion(const Board* board, Field old_field, Field new_field) {
-  const Figure* figure = board->getFigure(old_field);
-  if (figure == nullptr || figure->getType() != Figure::PAWN) {
+  const uint8_t code = board->getFields()[old_field.letter][old_field.number];
+  if (code == NoFigure || codeToType(code) != Figure::PAWN) {
     return false;
   }
-  Field::Number old_number = figure->getColor() == Figure::WHITE ? Field::SEVEN : Field::TWO;
-  Field::Number new_number = figure->getColor() == Figure::WHITE ? Field::EIGHT : Field::ONE;
+  Field::Number old_number = codeToColor(code) == Figure::WHITE ? Field::SEVEN : Field::TWO;
+  Field::Number new_number = codeToColor(code) == Figure::WHITE ? Field::EIGHT : Field::ONE;
   return old_field.number == old_number && new_field.number == new_number;
 }
 
 bool Figure::Move::isTwoSquaresPawnMove(const Board* board, Field old_field, Field new_field) {
-  const Figure* figure = board->getFigure(old_field);
-  if (figure == nullptr || figure->getType() != Figure::PAWN) {
+  const uint8_t code = board->getFields()[old_field.letter][old_field.number];
+  if (code == NoFigure || codeToType(code) != Figure::PAWN) {
     return false;
   }
   return abs(new_field.number - old_field.number) == 2;
@@ -291,93 +285,21 @@ std::unique_ptr<Figure> FiguresFactory::createFigure(
   assert(!"It should never reached this point.");
 }
 
-Figure::Figure(Board& board, Field field, Color color, int value) noexcept
-  : board_(board), field_(field), color_(color), value_(value) {
+Figure::Figure(Board& board, Field field, Color color, Type type, int value) noexcept
+  : board_(board), field_(field), color_(color), code_(createCode(type, color)), value_(value) {
 }
 
 bool Figure::operator==(const Figure& other) const {
-  return getType() == other.getType() && getColor() == other.getColor();
+  return code_ == other.code_;
 }
 
 bool Figure::operator!=(const Figure& other) const {
   return !(*this == other);
 }
 
-bool Pawn::canPromote() const {
-  return (getColor() == WHITE && field_.number == Field::SEVEN) ||
-         (getColor() == BLACK && field_.number == Field::TWO);
-}
-
 std::vector<Figure::Move> Pawn::calculatePossibleMoves() const {
   std::vector<Move> result;
-  Field::Letter current_l = field_.letter;
-  Field::Number current_n = field_.number;
-
-  const auto& fields = board_.getFields();
-  const int offset = getColor() == WHITE ? 1 : -1;
-
-  if (fields[current_l][current_n + offset] == nullptr) {
-    if (canPromote()) {
-      addMove(board_, result, this, current_l, current_n + offset, Figure::BISHOP);
-      addMove(board_, result, this, current_l, current_n + offset, Figure::KNIGHT);
-      addMove(board_, result, this, current_l, current_n + offset, Figure::ROOK);
-      addMove(board_, result, this, current_l, current_n + offset, Figure::QUEEN);
-    } else {
-      addMove(board_, result, this, current_l, current_n + offset);
-    }
-  }
-
-  if ((getColor() == WHITE && field_.number == Field::TWO) ||
-      (getColor() == BLACK && field_.number == Field::SEVEN)) {
-    if (fields[current_l][current_n + offset] == nullptr &&
-        fields[current_l][current_n + 2 * offset] == nullptr) {
-      addMove(board_, result, this, current_l, current_n + 2 * offset);
-    }
-  }
-
-  if (current_l != Field::A) {
-    const Figure* figure = fields[current_l - 1][current_n + offset];
-    if (figure != nullptr && figure->getColor() != getColor()) {
-      if (canPromote()) {
-        addMove(board_, result, this, current_l - 1, current_n + offset, Figure::BISHOP);
-        addMove(board_, result, this, current_l - 1, current_n + offset, Figure::KNIGHT);
-        addMove(board_, result, this, current_l - 1, current_n + offset, Figure::ROOK);
-        addMove(board_, result, this, current_l - 1, current_n + offset, Figure::QUEEN);
-      } else {
-        addMove(board_, result, this, current_l - 1, current_n + offset);
-      }
-    }
-  }
-
-  if (current_l != Field::H) {
-    const Figure* figure = fields[current_l + 1][current_n + offset];
-    if (figure != nullptr && figure->getColor() != getColor()) {
-      if (canPromote()) {
-        addMove(board_, result, this, current_l + 1, current_n + offset, Figure::BISHOP);
-        addMove(board_, result, this, current_l + 1, current_n + offset, Figure::KNIGHT);
-        addMove(board_, result, this, current_l + 1, current_n + offset, Figure::ROOK);
-        addMove(board_, result, this, current_l + 1, current_n + offset, Figure::QUEEN);
-      } else {
-        addMove(board_, result, this, current_l + 1, current_n + offset);
-      }
-    }
-  }
-
-  // Check for "en passant"
-  Field::Letter en_passant_file = board_.getEnPassantFile();
-  if (en_passant_file != Field::NONE) {
-    if ((getColor() == WHITE && field_.number == Field::FIVE) ||
-        (getColor() == BLACK && field_.number == Field::FOUR)) {
-      if (field_.letter != Field::A && field_.letter - 1 == en_passant_file) {
-        addMove(board_, result, this, current_l - 1, current_n + offset);
-        result[result.size() - 1].figure_beaten = true;
-      } else if (field_.letter != Field::H && field_.letter + 1 == en_passant_file) {
-        addMove(board_, result, this, current_l + 1, current_n + offset);
-        result[result.size() - 1].figure_beaten = true;
-      }
-    }
-  }
-
+  board_.calculatePawnMoves(getColor(), bitboard::fieldBB(field_), result);
   return result;
 }
 
@@ -405,8 +327,8 @@ std::vector<Figure::Move> Knight::calculatePossibleMoves() const {
   for (const auto& iter : possible_moves) {
     Field field(static_cast<Field::Letter>(iter.first),
                 static_cast<Field::Number>(iter.second));
-    const Figure* figure = board_.getFigure(field);
-    if (figure == nullptr || (figure != nullptr  && figure->getColor() != getColor())) {
+    const uint8_t code = board_.getFields()[field.letter][field.number];
+    if (code == NoFigure || codeToColor(code) != getColor()) {
       addMove(board_, result, this, field.letter, field.number);
     }
   }
@@ -416,20 +338,20 @@ std::vector<Figure::Move> Knight::calculatePossibleMoves() const {
 
 std::vector<Figure::Move> Bishop::calculatePossibleMoves() const {
   std::vector<Move> result;
-  calculateMovesForBishop(result, board_, field_);
+  calculateMovesForBishop(result, board_, this);
   return result;
 }
 
 std::vector<Figure::Move> Rook::calculatePossibleMoves() const {
   std::vector<Move> result;
-  calculateMovesForRook(result, board_, field_);
+  calculateMovesForRook(result, board_, this);
   return result;
 }
 
 std::vector<Figure::Move> Queen::calculatePossibleMoves() const {
   std::vector<Move> result;
-  calculateMovesForBishop(result, board_, field_);
-  calculateMovesForRook(result, board_, field_);
+  calculateMovesForBishop(result, board_, this);
+  calculateMovesForRook(result, board_, this);
   return result;
 }
 
@@ -454,10 +376,8 @@ std::vector<Figure::Move> King::calculatePossibleMoves() const {
                        iter.second < Field::ONE || iter.second > Field::EIGHT) {
                      return true;
                    }
-                   const Figure* figure = board_.getFigure(Field(
-                         static_cast<Field::Letter>(iter.first),
-                         static_cast<Field::Number>(iter.second)));
-                   if (figure != nullptr && figure->getColor() == this->getColor()) {
+                   const uint8_t code = board_.getFields()[iter.first][iter.second];
+                   if (code != NoFigure && codeToColor(code) == this->getColor()) {
                      return true;
                    }
                    return false;
@@ -467,51 +387,59 @@ std::vector<Figure::Move> King::calculatePossibleMoves() const {
   for (auto move : possible_moves) {
     addMove(board_, result, this, move.first, move.second);
   }
-  addPossibleCastlings(result);
+  if (getColor() == WHITE) {
+    addPossibleCastlings<WHITE>(result);
+  } else {
+    addPossibleCastlings<BLACK>(result);
+  }
 
   return result;
 }
 
 bool King::canCastle(bool king_side) const {
-  const Color color = getColor();
-  const Field::Number number = color == Figure::WHITE ? Field::ONE : Field::EIGHT;
+  return getColor() == WHITE ? canCastle<WHITE>(king_side) : canCastle<BLACK>(king_side);
+}
+
+template<Figure::Color Us>
+bool King::canCastle(bool king_side) const {
+  constexpr Field::Number number = ColorTraits<Us>::FirstLine;
   // Check if king is in the right position
   if (getPosition() != Field(Field::E, number)) {
     return false;
   }
 
+  const auto& fields = board_.getFields();
+  constexpr uint8_t rook = createCode(Figure::ROOK, Us);
   if (king_side == true) {
-    const Figure* figure = board_.getFigure(Field(Field::H, number));
-    if (figure && figure->getType() == Figure::ROOK && figure->getColor() == getColor() &&
-        board_.getFigure(Field(Field::F, number)) == nullptr &&
-        board_.getFigure(Field(Field::G, number)) == nullptr) {
+    if (fields[Field::H][number] == rook &&
+        fields[Field::F][number] == NoFigure &&
+        fields[Field::G][number] == NoFigure) {
       return true;
     }
   } else {
-    const Figure* figure = board_.getFigure(Field(Field::A, number));
-    if (figure && figure->getType() == Figure::ROOK && figure->getColor() == getColor() &&
-        board_.getFigure(Field(Field::D, number)) == nullptr &&
-        board_.getFigure(Field(Field::C, number)) == nullptr &&
-        board_.getFigure(Field(Field::B, number)) == nullptr) {
+    if (fields[Field::A][number] == rook &&
+        fields[Field::D][number] == NoFigure &&
+        fields[Field::C][number] == NoFigure &&
+        fields[Field::B][number] == NoFigure) {
       return true;
     }
   }
   return false;
 }
 
+template<Figure::Color Us>
 void King::addPossibleCastlings(std::vector<Move>& moves) const {
-  const Color color = getColor();
-  const Field::Number number = color == Figure::WHITE ? Field::ONE : Field::EIGHT;
+  constexpr Field::Number number = ColorTraits<Us>::FirstLine;
 
-  if (canCastle(true) == true) {
+  if (canCastle<Us>(true) == true) {
     moves.push_back(Figure::Move(Field(Field::E, number),
                                  Field(Field::G, number),
-                                 color == Figure::WHITE ? Figure::Move::Castling::K : Figure::Move::Castling::k));
+                                 ColorTraits<Us>::KingSideCastling));
   }
 
-  if (canCastle(false) == true) {
+  if (canCastle<Us>(false) == true) {
     moves.push_back(Figure::Move(Field(Field::E, number),
                                  Field(Field::C, number),
-                                 color == Figure::WHITE ? Figure::Move::Castling::Q : Figure::Move::Castling::q));
+                                 ColorTraits<Us>::QueenSideCastling));
   }
 }
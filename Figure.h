@@ -1,6 +1,7 @@
 #ifndef FIGURE_H
 #define FIGURE_H
 
+#include <cstdint>
 #include <memory>
 #include <ostream>
 #include <stdexcept>
@@ -60,9 +61,19 @@ class Figure {
     Type pawn_promotion{PAWN};
   };
 
+  // One byte code of a figure: type + 1 in the lowest three bits and color
+  // in the fourth one. Zero stands for an empty field.
+  static constexpr uint8_t NoFigure = 0;
+  static constexpr uint8_t createCode(Type type, Color color) {
+    return static_cast<uint8_t>((type + 1) | (color << 3));
+  }
+  static constexpr Type codeToType(uint8_t code) { return static_cast<Type>((code & 0x7) - 1); }
+  static constexpr Color codeToColor(uint8_t code) { return static_cast<Color>(code >> 3); }
+
   static Type charToFigureType(char c);
 
   Color getColor() const { return color_; }
+  uint8_t getCode() const { return code_; }
   Field getPosition() const { return field_; }
   void setPosition(const Field& field) { field_ = field; }
   int getValue() const { return value_; }
@@ -75,39 +86,50 @@ class Figure {
   bool operator!=(const Figure& other) const;
 
  protected:
-  Figure(Board& board, Field field, Color color, int value) noexcept;
+  Figure(Board& board, Field field, Color color, Type type, int value) noexcept;
 
   Board& board_;
   Field field_;
 
  private:
   const Color color_;
+  const uint8_t code_;
   const int value_;
 };
 
 std::ostream& operator<<(std::ostream& ostr, const Figure::Move& move);
 std::ostream& operator<<(std::ostream& ostr, const std::vector<Figure::Move>& moves);
 
-inline Figure::Color operator!(Figure::Color color) {
+constexpr Figure::Color operator!(Figure::Color color) {
   return (color == Figure::WHITE) ? Figure::BLACK : Figure::WHITE;
 }
 
+// Color dependent constants. Code specialized with template<Figure::Color Us>
+// uses them so that the color checks are resolved at compile time.
+template<Figure::Color Us>
+struct ColorTraits {
+  static constexpr Field::Number FirstLine = Us == Figure::WHITE ? Field::ONE : Field::EIGHT;
+  static constexpr Field::Number EnPassantLine = Us == Figure::WHITE ? Field::FIVE : Field::FOUR;
+  static constexpr Field::Number EnPassantTargetLine = Us == Figure::WHITE ? Field::SIX : Field::THREE;
+  static constexpr Figure::Move::Castling KingSideCastling =
+      Us == Figure::WHITE ? Figure::Move::Castling::K : Figure::Move::Castling::k;
+  static constexpr Figure::Move::Castling QueenSideCastling =
+      Us == Figure::WHITE ? Figure::Move::Castling::Q : Figure::Move::Castling::q;
+};
+
 class Pawn : public Figure {
  public:
   Pawn(Board& board, Field field, Color color) noexcept
-    : Figure(board, field, color, PAWN_VALUE) {}
+    : Figure(board, field, color, PAWN, PAWN_VALUE) {}
   std::vector<Move> calculatePossibleMoves() const override;
   Type getType() const override { return PAWN; }
   char getFENNotation() const override { return getColor() == Figure::WHITE ? 'P' : 'p'; }
-
- private:
-  bool canPromote() const;
 };
 
 class Knight : public Figure {
  public:
   Knight(Board& board, Field field, Color color) noexcept
-    : Figure(board, field, color, KNIGHT_VALUE) {}
+    : Figure(board, field, color, KNIGHT, KNIGHT_VALUE) {}
   std::vector<Move> calculatePossibleMoves() const override;
   Type getType() const override { return KNIGHT; }
   char getFENNotation() const override { return getColor() == Figure::WHITE ? 'N' : 'n'; }
@@ -116,7 +138,7 @@ class Knight : public Figure {
 class Bishop : public Figure {
  public:
   Bishop(Board& board, Field field, Color color) noexcept
-    : Figure(board, field, color, BISHOP_VALUE) {}
+    : Figure(board, field, color, BISHOP, BISHOP_VALUE) {}
   std::vector<Move> calculatePossibleMoves() const override;
   Type getType() const override { return BISHOP; }
   char getFENNotation() const override { return getColor() == Figure::WHITE ? 'B' : 'b'; }
@@ -125,7 +147,7 @@ class Bishop : public Figure {
 class Rook : public Figure {
  public:
   Rook(Board& board, Field field, Color color) noexcept
-    : Figure(board, field, color, ROOK_VALUE) {}
+    : Figure(board, field, color, ROOK, ROOK_VALUE) {}
   std::vector<Move> calculatePossibleMoves() const override;
   Type getType() const override { return ROOK; }
   char getFENNotation() const override { return getColor() == Figure::WHITE ? 'R' : 'r'; }
@@ -134,7 +156,7 @@ class Rook : public Figure {
 class Queen : public Figure {
  public:
   Queen(Board& board, Field field, Color color) noexcept
-    : Figure(board, field, color, QUEEN_VALUE) {}
+    : Figure(board, field, color, QUEEN, QUEEN_VALUE) {}
   std::vector<Move> calculatePossibleMoves() const override;
   Type getType() const override { return QUEEN; }
   char getFENNotation() const override { return getColor() == Figure::WHITE ? 'Q' : 'q'; }
@@ -143,14 +165,15 @@ class Queen : public Figure {
 class King : public Figure {
  public:
   King(Board& board, Field field, Color color) noexcept
-    : Figure(board, field, color, KING_VALUE) {}
+    : Figure(board, field, color, KING, KING_VALUE) {}
   std::vector<Move> calculatePossibleMoves() const override;
   Type getType() const override { return KING; }
   bool canCastle(bool king_side) const;
   char getFENNotation() const override { return getColor() == Figure::WHITE ? 'K' : 'k'; }
 
  private:
-  void addPossibleCastlings(std::vector<Move>& moves) const;
+  template<Color Us> bool canCastle(bool king_side) const;
+  template<Color Us> void addPossibleCastlings(std::vector<Move>& moves) const;
 };
 
 class FiguresFactory {
@@ -0,0 +1,160 @@
+#include "MateSolver.h"
+
+#include <algorithm>
+
+
+MateSolver::MateSolver(Board& board, const std::atomic<bool>& stop, size_t max_memory)
+  : board_(board), stop_(stop), max_number_of_nodes_(std::max(max_memory / sizeof(Node), MaxNumberOfMoves + 1)) {
+  // Pages of the reserved memory are mapped only once nodes are stored.
+  nodes_.reserve(max_number_of_nodes_);
+}
+
+bool MateSolver::solve(unsigned moves_to_mate, std::vector<Figure::Move>& line) {
+  number_of_nodes_ = 0u;
+  // Short mates are cheap to disprove, so trying every length in turn
+  // costs little and the first mate found is the shortest one.
+  for (unsigned moves = 1; moves <= moves_to_mate; ++moves) {
+    if (prove(2 * moves - 1) == false) {
+      if (nodes_[0].disproof != 0) {
+        // Interrupted or out of memory.
+        return false;
+      }
+      continue;
+    }
+    line.clear();
+    uint32_t index = 0;
+    for (unsigned ply = 0; nodes_[index].number_of_children > 0; ++ply) {
+      index = selectLineChild(index, ply);
+      line.push_back(nodes_[index].move);
+    }
+    return true;
+  }
+  return false;
+}
+
+bool MateSolver::prove(unsigned plies) {
+  nodes_.clear();
+  nodes_.emplace_back();
+  while (nodes_[0].proof != 0 && nodes_[0].disproof != 0) {
+    if (stop_ == true || nodes_.size() + MaxNumberOfMoves > max_number_of_nodes_) {
+      return false;
+    }
+    // Walk down to the most proving node, making the moves on the way.
+    uint32_t index = 0;
+    unsigned ply = 0;
+    while (nodes_[index].expanded == true) {
+      index = selectChild(index, ply);
+      board_.makeMove(nodes_[index].move, true);
+      ++ply;
+    }
+    expand(index, ply, plies);
+    // Only the nodes on the path can change.
+    while (index != 0) {
+      update(index, ply);
+      board_.undoLastReversibleMove();
+      index = nodes_[index].parent;
+      --ply;
+    }
+    update(0, 0);
+  }
+  return nodes_[0].proof == 0;
+}
+
+void MateSolver::expand(uint32_t index, unsigned ply, unsigned plies) {
+  const bool attacker = ply % 2 == 0;
+  const std::vector<Figure::Move> moves = board_.calculateMovesForFigures(board_.getSideToMove());
+  const uint32_t first_child = static_cast<uint32_t>(nodes_.size());
+  for (const Figure::Move& move: moves) {
+    Node child;
+    child.move = move;
+    child.parent = index;
+    if (attacker == true) {
+      if (move.is_mate == true) {
+        // A single mate proves the node, the other moves are not needed.
+        nodes_.resize(first_child);
+        child.proof = 0;
+        child.disproof = Infinity;
+        child.expanded = true;
+        nodes_.push_back(child);
+        break;
+      }
+      // Only a mate counts on the last ply.
+      if (move.is_check == false || ply + 1 == plies) {
+        continue;
+      }
+    }
+    nodes_.push_back(child);
+  }
+  Node& node = nodes_[index];
+  node.expanded = true;
+  node.first_child = first_child;
+  node.number_of_children = static_cast<uint32_t>(nodes_.size()) - first_child;
+  number_of_nodes_ += node.number_of_children;
+  if (node.number_of_children == 0) {
+    // The attacker has no check or the defender is stalemated, mates of the
+    // defender are known from the move leading to the node.
+    node.proof = Infinity;
+    node.disproof = 0;
+  }
+}
+
+void MateSolver::update(uint32_t index, unsigned ply) {
+  Node& node = nodes_[index];
+  if (node.number_of_children == 0) {
+    return;
+  }
+  // The attacker needs to prove one child and the defender needs to
+  // disprove one, the other side has to cope with all of them.
+  uint32_t minimum = Infinity;
+  uint64_t sum = 0;
+  const bool attacker = ply % 2 == 0;
+  for (uint32_t i = node.first_child; i < node.first_child + node.number_of_children; ++i) {
+    const Node& child = nodes_[i];
+    minimum = std::min(minimum, attacker == true ? child.proof : child.disproof);
+    sum += attacker == true ? child.disproof : child.proof;
+  }
+  const uint32_t total = static_cast<uint32_t>(std::min<uint64_t>(sum, Infinity));
+  node.proof = attacker == true ? minimum : total;
+  node.disproof = attacker == true ? total : minimum;
+}
+
+uint32_t MateSolver::selectChild(uint32_t index, unsigned ply) const {
+  const Node& node = nodes_[index];
+  const bool attacker = ply % 2 == 0;
+  uint32_t best = node.first_child;
+  for (uint32_t i = node.first_child + 1; i < node.first_child + node.number_of_children; ++i) {
+    if (attacker == true ? nodes_[i].proof < nodes_[best].proof : nodes_[i].disproof < nodes_[best].disproof) {
+      best = i;
+    }
+  }
+  return best;
+}
+
+unsigned MateSolver::calculateMateLength(uint32_t index, unsigned ply) const {
+  const Node& node = nodes_[index];
+  if (node.number_of_children == 0) {
+    return 0;
+  }
+  const uint32_t child = selectLineChild(index, ply);
+  return 1 + calculateMateLength(child, ply + 1);
+}
+
+// The attacker takes the quickest proven mate, the defender the slowest one.
+uint32_t MateSolver::selectLineChild(uint32_t index, unsigned ply) const {
+  const Node& node = nodes_[index];
+  const bool attacker = ply % 2 == 0;
+  uint32_t best = node.first_child + node.number_of_children;
+  unsigned best_length = 0;
+  for (uint32_t i = node.first_child; i < node.first_child + node.number_of_children; ++i) {
+    if (nodes_[i].proof != 0) {
+      continue;
+    }
+    const unsigned length = calculateMateLength(i, ply + 1);
+    if (best == node.first_child + node.number_of_children ||
+        (attacker == true ? length < best_length : length > best_length)) {
+      best = i;
+      best_length = length;
+    }
+  }
+  return best;
+}
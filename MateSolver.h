@@ -0,0 +1,64 @@
+#ifndef MATE_SOLVER_H
+#define MATE_SOLVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "Board.h"
+#include "Figure.h"
+
+
+// Proof-number search for a forced mate. The attacker only tries checking
+// moves, the defender tries all evasions, and the most proving node of the
+// whole tree is expanded next. Forced lines with few replies are proven
+// long before a full-width search reaches their depth.
+class MateSolver {
+ public:
+  // The tree is kept in memory allocated up front, the search gives up once
+  // it would outgrow max_memory (in bytes) or stop is set.
+  MateSolver(Board& board, const std::atomic<bool>& stop, size_t max_memory);
+  MateSolver(const MateSolver&) = delete;
+  MateSolver& operator=(const MateSolver&) = delete;
+
+  // Looks for the shortest mate of the side to move in at most the given
+  // number of moves and returns its line with the longest defense.
+  bool solve(unsigned moves_to_mate, std::vector<Figure::Move>& line);
+  unsigned getNumberOfNodes() const noexcept { return number_of_nodes_; }
+
+ private:
+  static constexpr uint32_t Infinity = std::numeric_limits<uint32_t>::max();
+  // No position has more legal moves, an expansion never adds more nodes.
+  static constexpr size_t MaxNumberOfMoves = 256;
+
+  struct Node {
+    // Move leading to the node, none at the root.
+    Figure::Move move;
+    uint32_t parent{0};
+    // Children are added together, so they are stored next to each other.
+    uint32_t first_child{0};
+    uint32_t number_of_children{0};
+    // Number of leaves still to be proven (disproven) to prove (disprove)
+    // the node.
+    uint32_t proof{1};
+    uint32_t disproof{1};
+    bool expanded{false};
+  };
+
+  // Plies are counted from the root, the attacker moves on even ones.
+  bool prove(unsigned plies);
+  void expand(uint32_t index, unsigned ply, unsigned plies);
+  void update(uint32_t index, unsigned ply);
+  uint32_t selectChild(uint32_t index, unsigned ply) const;
+  unsigned calculateMateLength(uint32_t index, unsigned ply) const;
+  uint32_t selectLineChild(uint32_t index, unsigned ply) const;
+
+  Board& board_;
+  const std::atomic<bool>& stop_;
+  const size_t max_number_of_nodes_;
+  std::vector<Node> nodes_;
+  unsigned number_of_nodes_{0u};
+};
+
+#endif  // MATE_SOLVER_H
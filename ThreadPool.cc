@@ -0,0 +1,76 @@
+#include "ThreadPool.h"
+
+
+ThreadPool::ThreadPool(size_t number_of_threads) {
+  startThreads(number_of_threads);
+}
+
+ThreadPool::~ThreadPool() {
+  stopThreads();
+}
+
+void ThreadPool::resize(size_t number_of_threads) {
+  if (number_of_threads == threads_.size()) {
+    return;
+  }
+  waitForAllTasks();
+  stopThreads();
+  startThreads(number_of_threads);
+}
+
+size_t ThreadPool::getNumberOfIdleThreads() {
+  std::lock_guard<std::mutex> lg(mutex_);
+  const size_t pending = number_of_busy_threads_ + tasks_.size();
+  return pending < threads_.size() ? threads_.size() - pending : 0u;
+}
+
+void ThreadPool::addTask(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lg(mutex_);
+    tasks_.push_back(std::move(task));
+  }
+  task_added_cv_.notify_one();
+}
+
+void ThreadPool::waitForAllTasks() {
+  std::unique_lock<std::mutex> ul(mutex_);
+  task_finished_cv_.wait(ul, [this] { return tasks_.empty() == true && number_of_busy_threads_ == 0; });
+}
+
+void ThreadPool::startThreads(size_t number_of_threads) {
+  stopping_ = false;
+  for (size_t i = 0; i < number_of_threads; ++i) {
+    threads_.emplace_back(&ThreadPool::workerMain, this);
+  }
+}
+
+void ThreadPool::stopThreads() {
+  {
+    std::lock_guard<std::mutex> lg(mutex_);
+    stopping_ = true;
+  }
+  task_added_cv_.notify_all();
+  for (auto& thread: threads_) {
+    thread.join();
+  }
+  threads_.clear();
+}
+
+void ThreadPool::workerMain() {
+  std::unique_lock<std::mutex> ul(mutex_);
+  while (true) {
+    task_added_cv_.wait(ul, [this] { return stopping_ == true || tasks_.empty() == false; });
+    // Queued tasks are finished before the worker quits.
+    if (tasks_.empty() == true) {
+      return;
+    }
+    auto task = std::move(tasks_.front());
+    tasks_.pop_front();
+    ++number_of_busy_threads_;
+    ul.unlock();
+    task();
+    ul.lock();
+    --number_of_busy_threads_;
+    task_finished_cv_.notify_all();
+  }
+}
@@ -0,0 +1,42 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// Fixed set of worker threads executing queued tasks in FIFO order. The
+// workers live as long as the pool and are joined by its destructor.
+class ThreadPool {
+ public:
+  explicit ThreadPool(size_t number_of_threads = 0u);
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+  ~ThreadPool();
+
+  // Waits for queued tasks and replaces the workers with a new set.
+  void resize(size_t number_of_threads);
+  size_t getNumberOfThreads() const noexcept { return threads_.size(); }
+  size_t getNumberOfIdleThreads();
+  void addTask(std::function<void()> task);
+  void waitForAllTasks();
+
+ private:
+  void startThreads(size_t number_of_threads);
+  void stopThreads();
+  void workerMain();
+
+  std::vector<std::thread> threads_;
+  std::deque<std::function<void()>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable task_added_cv_;
+  std::condition_variable task_finished_cv_;
+  size_t number_of_busy_threads_{0u};
+  bool stopping_{false};
+};
+
+#endif  // THREAD_POOL_H
@@ -0,0 +1,58 @@
+/* Component tests for class ThreadPool */
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+
+#include "utils/Test.h"
+#include "ThreadPool.h"
+
+
+namespace {
+
+TEST_PROCEDURE(ThreadPoolExecutesTasks) {
+  TEST_START
+  std::atomic<unsigned> counter{0u};
+  {
+    ThreadPool pool(3);
+    VERIFY_EQUALS(pool.getNumberOfThreads(), 3u);
+    for (unsigned i = 0; i < 100; ++i) {
+      pool.addTask([&counter] { ++counter; });
+    }
+    pool.waitForAllTasks();
+    VERIFY_EQUALS(counter.load(), 100u);
+    // Tasks still queued are finished before the workers are joined.
+    for (unsigned i = 0; i < 10; ++i) {
+      pool.addTask([&counter] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ++counter;
+      });
+    }
+  }
+  VERIFY_EQUALS(counter.load(), 110u);
+  TEST_END
+}
+
+TEST_PROCEDURE(ThreadPoolCountsIdleThreads) {
+  TEST_START
+  ThreadPool pool(2);
+  VERIFY_EQUALS(pool.getNumberOfIdleThreads(), 2u);
+  std::promise<void> started;
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  pool.addTask([&started, released] {
+    started.set_value();
+    released.wait();
+  });
+  started.get_future().wait();
+  VERIFY_EQUALS(pool.getNumberOfIdleThreads(), 1u);
+  release.set_value();
+  pool.waitForAllTasks();
+  VERIFY_EQUALS(pool.getNumberOfIdleThreads(), 2u);
+  pool.resize(4);
+  VERIFY_EQUALS(pool.getNumberOfIdleThreads(), 4u);
+  TEST_END
+}
+
+} // unnamed namespace
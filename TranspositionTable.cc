@@ -0,0 +1,104 @@
+#include "TranspositionTable.h"
+
+#include <algorithm>
+
+#include "Bitboard.h"
+
+
+namespace {
+
+constexpr uint16_t NoMove = 0;
+
+uint16_t encodeMove(const Figure::Move& move) {
+  return static_cast<uint16_t>(bitboard::toSquare(move.old_field) |
+                               (bitboard::toSquare(move.new_field) << 6) |
+                               (move.pawn_promotion << 12));
+}
+
+}  // unnamed namespace
+
+void TranspositionTable::resize(size_t size_in_bytes) {
+  size_t number_of_clusters = 1;
+  while (number_of_clusters * 2 * sizeof(Cluster) <= size_in_bytes) {
+    number_of_clusters *= 2;
+  }
+  memory_.reset();
+  clusters_ = nullptr;
+  number_of_clusters_ = 0;
+  memory_.reset(std::calloc(number_of_clusters * sizeof(Cluster) + alignof(Cluster) - 1, 1));
+  if (memory_ == nullptr) {
+    return;
+  }
+  const uintptr_t address = reinterpret_cast<uintptr_t>(memory_.get());
+  clusters_ = reinterpret_cast<Cluster*>((address + alignof(Cluster) - 1) & ~(alignof(Cluster) - 1));
+  number_of_clusters_ = number_of_clusters;
+  generation_ = 0;
+}
+
+uint64_t TranspositionTable::pack(int score, uint16_t move, unsigned depth, Bound bound, uint8_t generation) noexcept {
+  return static_cast<uint64_t>(static_cast<uint32_t>(score)) |
+         (static_cast<uint64_t>(move) << 32) |
+         (static_cast<uint64_t>(std::min(depth, 0xFFu)) << 48) |
+         (static_cast<uint64_t>(bound) << 56) |
+         (static_cast<uint64_t>(generation) << 58);
+}
+
+bool TranspositionTable::probe(uint64_t hash, Entry& entry) const noexcept {
+  if (number_of_clusters_ == 0) {
+    return false;
+  }
+  for (const Slot& slot: getCluster(hash).slots) {
+    const uint64_t data = slot.data.load(std::memory_order_relaxed);
+    if ((slot.key.load(std::memory_order_relaxed) ^ data) != hash || getBound(data) == Bound::NONE) {
+      continue;
+    }
+    entry.score = static_cast<int32_t>(static_cast<uint32_t>(data));
+    entry.depth = getDepth(data);
+    entry.bound = getBound(data);
+    const uint16_t move = getMove(data);
+    entry.has_move = move != NoMove;
+    entry.old_field = bitboard::toField(move & 0x3F);
+    entry.new_field = bitboard::toField((move >> 6) & 0x3F);
+    entry.pawn_promotion = static_cast<Figure::Type>(move >> 12);
+    return true;
+  }
+  return false;
+}
+
+void TranspositionTable::store(uint64_t hash, unsigned depth, Bound bound, int score,
+                               const Figure::Move* move) noexcept {
+  if (number_of_clusters_ == 0) {
+    return;
+  }
+  Cluster& cluster = getCluster(hash);
+  Slot* replaced = nullptr;
+  int worst_value = 0;
+  for (Slot& slot: cluster.slots) {
+    const uint64_t data = slot.data.load(std::memory_order_relaxed);
+    if ((slot.key.load(std::memory_order_relaxed) ^ data) == hash) {
+      // Shallower results of the current search don't replace deeper ones.
+      if (getGeneration(data) == generation_ && bound != Bound::EXACT && depth + 2 < getDepth(data)) {
+        return;
+      }
+      replaced = &slot;
+      if (move == nullptr) {
+        const uint16_t old_move = getMove(data);
+        const uint64_t new_data = pack(score, old_move, depth, bound, generation_);
+        slot.key.store(hash ^ new_data, std::memory_order_relaxed);
+        slot.data.store(new_data, std::memory_order_relaxed);
+        return;
+      }
+      break;
+    }
+    // Entries left by older searches lose 8 plies of depth per search.
+    const int age = (generation_ - getGeneration(data)) & GenerationMask;
+    const int value = static_cast<int>(getDepth(data)) - 8 * age;
+    if (replaced == nullptr || value < worst_value) {
+      replaced = &slot;
+      worst_value = value;
+    }
+  }
+  const uint64_t data = pack(score, move != nullptr ? encodeMove(*move) : NoMove, depth, bound, generation_);
+  replaced->key.store(hash ^ data, std::memory_order_relaxed);
+  replaced->data.store(data, std::memory_order_relaxed);
+}
@@ -0,0 +1,97 @@
+#ifndef TRANSPOSITION_TABLE_H
+#define TRANSPOSITION_TABLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+
+#include "Field.h"
+#include "Figure.h"
+
+
+// Cache of search results shared by all search threads without locks.
+// Every slot keeps the hash XOR-ed with the data, so a slot torn by two
+// threads writing it at once fails verification instead of being misread.
+class TranspositionTable {
+ public:
+  enum class Bound : uint8_t {
+    NONE,
+    EXACT,
+    // The score is at least the stored one (beta cutoff).
+    LOWER,
+    // The score is at most the stored one (no move raised alpha).
+    UPPER
+  };
+
+  struct Entry {
+    int score{0};
+    unsigned depth{0u};
+    Bound bound{Bound::NONE};
+    bool has_move{false};
+    Field old_field;
+    Field new_field;
+    Figure::Type pawn_promotion{Figure::PAWN};
+
+    bool isSameMove(const Figure::Move& move) const noexcept {
+      return has_move == true && move.old_field == old_field &&
+             move.new_field == new_field && move.pawn_promotion == pawn_promotion;
+    }
+  };
+
+  TranspositionTable() = default;
+  TranspositionTable(const TranspositionTable&) = delete;
+  TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+  // Allocates the biggest power of two number of clusters fitting in the
+  // given size, all entries are empty afterwards.
+  void resize(size_t size_in_bytes);
+  size_t getSizeInBytes() const noexcept { return number_of_clusters_ * sizeof(Cluster); }
+  // Starts a new search, entries of older searches are replaced first.
+  void newSearch() noexcept { generation_ = (generation_ + 1) & GenerationMask; }
+
+  bool probe(uint64_t hash, Entry& entry) const noexcept;
+  void store(uint64_t hash, unsigned depth, Bound bound, int score, const Figure::Move* move) noexcept;
+
+  // public for testing purposes
+  static constexpr size_t ClusterSize = 4;
+
+  struct Slot {
+    std::atomic<uint64_t> key;
+    std::atomic<uint64_t> data;
+  };
+
+  Slot& getSlot(uint64_t hash, size_t index) const noexcept { return getCluster(hash).slots[index]; }
+  size_t getNumberOfClusters() const noexcept { return number_of_clusters_; }
+
+ private:
+  static constexpr uint8_t GenerationMask = 0x3F;
+
+  // Slots sharing one index fill exactly one cache line.
+  struct alignas(64) Cluster {
+    Slot slots[ClusterSize];
+  };
+
+  // Data layout: score (32 bits), move (16 bits), depth (8 bits),
+  // bound (2 bits), generation (6 bits).
+  static uint64_t pack(int score, uint16_t move, unsigned depth, Bound bound, uint8_t generation) noexcept;
+  static uint16_t getMove(uint64_t data) noexcept { return static_cast<uint16_t>(data >> 32); }
+  static unsigned getDepth(uint64_t data) noexcept { return (data >> 48) & 0xFF; }
+  static Bound getBound(uint64_t data) noexcept { return static_cast<Bound>((data >> 56) & 0x3); }
+  static uint8_t getGeneration(uint64_t data) noexcept { return (data >> 58) & GenerationMask; }
+
+  Cluster& getCluster(uint64_t hash) const noexcept { return clusters_[hash & (number_of_clusters_ - 1)]; }
+
+  struct FreeDeleter {
+    void operator()(void* memory) const noexcept { std::free(memory); }
+  };
+
+  // Zeroed pages of calloc()ed memory are mapped on first use, so a big
+  // table costs nothing until the search fills it.
+  std::unique_ptr<void, FreeDeleter> memory_;
+  Cluster* clusters_{nullptr};
+  size_t number_of_clusters_{0};
+  uint8_t generation_{0};
+};
+
+#endif  // TRANSPOSITION_TABLE_H
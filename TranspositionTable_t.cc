@@ -0,0 +1,143 @@
+/* Component tests for class TranspositionTable */
+
+#include <cstdint>
+
+#include "utils/Test.h"
+#include "Field.h"
+#include "Figure.h"
+#include "TranspositionTable.h"
+
+
+namespace {
+
+const size_t TableSize = 1 << 16;
+
+Figure::Move createMove(const char* old_field, const char* new_field, Figure::Type promotion = Figure::PAWN) {
+  return Figure::Move(Field(old_field), Field(new_field), promotion);
+}
+
+TEST_PROCEDURE(TranspositionTableReturnsStoredEntries) {
+  TEST_START
+  TranspositionTable table;
+  TranspositionTable::Entry entry;
+  VERIFY_FALSE(table.probe(0x1234u, entry));
+  table.resize(TableSize);
+  VERIFY_EQUALS(table.getSizeInBytes(), TableSize);
+  VERIFY_FALSE(table.probe(0x1234u, entry));
+
+  const Figure::Move move = createMove("e7", "e8", Figure::KNIGHT);
+  table.store(0x1234u, 7u, TranspositionTable::Bound::LOWER, -321, &move);
+  VERIFY_TRUE(table.probe(0x1234u, entry));
+  VERIFY_EQUALS(entry.score, -321);
+  VERIFY_EQUALS(entry.depth, 7u);
+  VERIFY_TRUE(entry.bound == TranspositionTable::Bound::LOWER);
+  VERIFY_TRUE(entry.isSameMove(move));
+  VERIFY_FALSE(entry.isSameMove(createMove("e7", "e8", Figure::QUEEN)));
+
+  // A store without a move keeps the known one.
+  table.store(0x1234u, 8u, TranspositionTable::Bound::EXACT, 55, nullptr);
+  VERIFY_TRUE(table.probe(0x1234u, entry));
+  VERIFY_EQUALS(entry.score, 55);
+  VERIFY_EQUALS(entry.depth, 8u);
+  VERIFY_TRUE(entry.bound == TranspositionTable::Bound::EXACT);
+  VERIFY_TRUE(entry.isSameMove(move));
+
+  table.store(0x5678u, 1u, TranspositionTable::Bound::UPPER, 10, nullptr);
+  VERIFY_TRUE(table.probe(0x5678u, entry));
+  VERIFY_FALSE(entry.has_move);
+  VERIFY_FALSE(table.probe(0x9ABCu, entry));
+  TEST_END
+}
+
+TEST_PROCEDURE(TranspositionTableRejectsTornSlots) {
+  TEST_START
+  TranspositionTable table;
+  table.resize(TableSize);
+  const uint64_t hash = 0xDEADBEEFu;
+  table.store(hash, 5u, TranspositionTable::Bound::EXACT, 100, nullptr);
+  TranspositionTable::Entry entry;
+  VERIFY_TRUE(table.probe(hash, entry));
+
+  // The first store of an empty cluster goes to its first slot. Data written
+  // by another thread after the key no longer matches it.
+  TranspositionTable::Slot& slot = table.getSlot(hash, 0);
+  VERIFY_EQUALS(slot.key.load() ^ slot.data.load(), hash);
+  slot.data.store(slot.data.load() ^ 1u);
+  VERIFY_FALSE(table.probe(hash, entry));
+  TEST_END
+}
+
+TEST_PROCEDURE(TranspositionTableKeepsDeeperEntries) {
+  TEST_START
+  TranspositionTable table;
+  table.resize(TableSize);
+  TranspositionTable::Entry entry;
+  const uint64_t hash = 0x42u;
+  table.store(hash, 10u, TranspositionTable::Bound::LOWER, 50, nullptr);
+
+  table.store(hash, 7u, TranspositionTable::Bound::LOWER, 20, nullptr);
+  VERIFY_TRUE(table.probe(hash, entry));
+  VERIFY_EQUALS(entry.depth, 10u);
+  VERIFY_EQUALS(entry.score, 50);
+
+  // Exact scores and results only slightly shallower replace the entry.
+  table.store(hash, 6u, TranspositionTable::Bound::EXACT, 30, nullptr);
+  VERIFY_TRUE(table.probe(hash, entry));
+  VERIFY_EQUALS(entry.depth, 6u);
+  VERIFY_EQUALS(entry.score, 30);
+  table.store(hash, 4u, TranspositionTable::Bound::UPPER, 25, nullptr);
+  VERIFY_TRUE(table.probe(hash, entry));
+  VERIFY_EQUALS(entry.depth, 4u);
+
+  // Entries of older searches never block new results.
+  table.store(hash, 12u, TranspositionTable::Bound::LOWER, 70, nullptr);
+  table.newSearch();
+  table.store(hash, 2u, TranspositionTable::Bound::UPPER, 15, nullptr);
+  VERIFY_TRUE(table.probe(hash, entry));
+  VERIFY_EQUALS(entry.depth, 2u);
+  VERIFY_EQUALS(entry.score, 15);
+  TEST_END
+}
+
+TEST_PROCEDURE(TranspositionTableReplacesEntriesOfOlderSearchesFirst) {
+  TEST_START
+  TranspositionTable table;
+  table.resize(TableSize);
+  TranspositionTable::Entry entry;
+  // Hashes differing only above the index bits share one cluster.
+  const uint64_t step = table.getNumberOfClusters();
+  uint64_t hashes[TranspositionTable::ClusterSize + 1];
+  for (size_t i = 0; i < TranspositionTable::ClusterSize + 1; ++i) {
+    hashes[i] = 7u + i * step;
+  }
+
+  for (size_t i = 0; i < TranspositionTable::ClusterSize - 1; ++i) {
+    table.store(hashes[i], 10u, TranspositionTable::Bound::EXACT, 0, nullptr);
+  }
+  table.newSearch();
+  const size_t last = TranspositionTable::ClusterSize - 1;
+  table.store(hashes[last], 3u, TranspositionTable::Bound::EXACT, 0, nullptr);
+  for (size_t i = 0; i <= last; ++i) {
+    VERIFY_TRUE(table.probe(hashes[i], entry));
+  }
+
+  // The cluster is full, the shallow entry of the current search outlives
+  // the deeper ones of the previous search.
+  table.store(hashes[last + 1], 1u, TranspositionTable::Bound::EXACT, 0, nullptr);
+  VERIFY_TRUE(table.probe(hashes[last + 1], entry));
+  VERIFY_TRUE(table.probe(hashes[last], entry));
+  unsigned number_of_old_entries = 0u;
+  for (size_t i = 0; i < last; ++i) {
+    number_of_old_entries += table.probe(hashes[i], entry) == true ? 1u : 0u;
+  }
+  VERIFY_EQUALS(number_of_old_entries, static_cast<unsigned>(last - 1));
+
+  // Without a new search the shallowest entry goes.
+  table.store(hashes[0], 9u, TranspositionTable::Bound::EXACT, 0, nullptr);
+  VERIFY_TRUE(table.probe(hashes[0], entry));
+  VERIFY_TRUE(table.probe(hashes[last], entry));
+  VERIFY_FALSE(table.probe(hashes[last + 1], entry));
+  TEST_END
+}
+
+} // unnamed namespace
@@ -1,8 +1,10 @@
 #include "UCIHandler.h"
 
 #include <algorithm>
+#include <cctype>
 #include <iostream>
 #include <map>
+#include <sstream>
 #include <string>
 #include <thread>
 #include <vector>
@@ -24,9 +26,24 @@ const std::map<const char*,
   {"position", &UCIHandler::handleCommandPosition},
   {"go", &UCIHandler::handleCommandGo},
   {"stop", &UCIHandler::handleCommandStop},
+  {"setoption", &UCIHandler::handleCommandSetOption},
   {"quit", &UCIHandler::handleCommandQuit}
 };
 
+// Options of type spin tuning Engine::PruningMargins.
+struct SpinOption {
+  const char* name;
+  int Engine::PruningMargins::* value;
+  int min;
+  int max;
+};
+
+const SpinOption g_spin_options[] = {
+  {"FutilityMargin", &Engine::PruningMargins::futility, 0, 1000},
+  {"ReverseFutilityMargin", &Engine::PruningMargins::reverse_futility, 0, 1000},
+  {"RazoringMargin", &Engine::PruningMargins::razoring, 0, 2000}
+};
+
 constexpr char MyName[] = "CKEngine";
 constexpr char CurrentVersion[] = "0.1";
 constexpr char Author[] = "Cezary Kułakowski";
@@ -63,16 +80,25 @@ void UCIHandler::start() {
 }
 
 void UCIHandler::handleCommand(const std::string& line) {
-  std::string command = line;
-  LogWithEndLine(Logger::LogSection::UCI_HANDLER, "Received command: ", command);
-  utils::ltrim(command);
-  auto space_position = command.find(' ');
+  LogWithEndLine(Logger::LogSection::UCI_HANDLER, "Received command: ", line);
+  // Split the line in a single pass, every token is copied once.
   std::string cmd;
-  if (space_position == std::string::npos) {
-    cmd = command;
-  } else {
-    cmd = command.substr(0, space_position);
+  std::vector<std::string> params;
+  auto is_space = [](char c) { return std::isspace(static_cast<unsigned char>(c)) != 0; };
+  auto token_end = line.begin();
+  while (true) {
+    auto token_begin = std::find_if_not(token_end, line.end(), is_space);
+    if (token_begin == line.end()) {
+      break;
+    }
+    token_end = std::find_if(token_begin, line.end(), is_space);
+    if (cmd.empty() == true) {
+      cmd.assign(token_begin, token_end);
+    } else {
+      params.emplace_back(token_begin, token_end);
+    }
   }
+
   auto iter = std::find_if(std::begin(g_handlers),
                            std::end(g_handlers),
                            [cmd] (const auto& m) -> bool {
@@ -83,22 +109,6 @@ void UCIHandler::handleCommand(const std::string& line) {
   }
   LogWithEndLine(Logger::LogSection::UCI_HANDLER, "Recognized command: ", cmd);
 
-  std::vector<std::string> params;
-  while (space_position != std::string::npos) {
-    command = command.substr(space_position);
-    utils::ltrim(command);
-    space_position = command.find(' ');
-    std::string param;
-    if (space_position == std::string::npos) {
-      param = command;
-    } else {
-      param = command.substr(0, space_position);
-    }
-    if (param.empty() == false) {
-      params.push_back(param);
-    }
-  }
-
   bool result = (this->*(iter->second))(params);
   if (result == true) {
     LogWithEndLine(Logger::LogSection::UCI_HANDLER, "Handle of command ", cmd, " succeeded.");
@@ -110,6 +120,11 @@ void UCIHandler::handleCommand(const std::string& line) {
 bool UCIHandler::handleCommandUCI(const std::vector<std::string>& params) {
   ostr_ << "id name " << MyName << " " << CurrentVersion << std::endl;
   ostr_ << "id author " << Author << std::endl;
+  const Engine::PruningMargins defaults;
+  for (const auto& option: g_spin_options) {
+    ostr_ << "option name " << option.name << " type spin default " << defaults.*option.value
+          << " min " << option.min << " max " << option.max << std::endl;
+  }
   ostr_ << "uciok" << std::endl;
   return true;
 }
@@ -124,6 +139,11 @@ bool UCIHandler::handleCommandPosition(const std::vector<std::string>& params) {
     LogWithEndLine(Logger::LogSection::UCI_HANDLER, "position: got no parameters");
     return false;
   }
+  // The board is set up again only when the command doesn't extend the
+  // previous one; otherwise only the appended moves are made.
+  std::vector<std::string> previous_params;
+  previous_params.swap(last_position_params_);
+
   unsigned current_param_index = 0;
   if (params[0] == "fen") {
     if (params.size() < 7) {
@@ -131,6 +151,32 @@ bool UCIHandler::handleCommandPosition(const std::vector<std::string>& params) {
       return false;
     }
     current_param_index = 7u;
+  } else if (params[0] == "startpos") {
+    current_param_index = 1u;
+  } else {
+    LogWithEndLine(Logger::LogSection::UCI_HANDLER, "position: bad parameter: ", params[0]);
+    return false;
+  }
+
+  if (params.size() > current_param_index) {
+    if (params[current_param_index] != "moves") {
+      LogWithEndLine(Logger::LogSection::UCI_HANDLER, "position: \"moves\" expected, got \"", params[current_param_index], "\"");
+      return false;
+    }
+    ++current_param_index;
+    if (current_param_index >= params.size()) {
+      LogWithEndLine(Logger::LogSection::UCI_HANDLER, "position: keyword moves found but no moves were specified");
+      return false;
+    }
+  }
+
+  const bool extends_previous = previous_params.empty() == false &&
+                                previous_params.size() <= params.size() &&
+                                std::equal(previous_params.begin(), previous_params.end(), params.begin());
+  if (extends_previous == true) {
+    LogWithEndLine(Logger::LogSection::UCI_HANDLER, "position: extends previous position");
+    current_param_index = std::max<unsigned>(current_param_index, previous_params.size());
+  } else if (params[0] == "fen") {
     std::string fen;
     for (int i = 1; i < 7; ++i) {
       fen += params[i] + " ";
@@ -141,29 +187,11 @@ bool UCIHandler::handleCommandPosition(const std::vector<std::string>& params) {
       LogWithEndLine(Logger::LogSection::UCI_HANDLER, "position: got wrong fen: ", fen);
       return false;
     }
-  } else if (params[0] == "startpos") {
-    current_param_index = 1u;
+  } else {
     board_.setStandardBoard();
     LogWithEndLine(Logger::LogSection::UCI_HANDLER, "position: set starting position");
-  } else {
-    LogWithEndLine(Logger::LogSection::UCI_HANDLER, "position: bad parameter: ", params[0]);
-    return false;
   }
 
-  if (params.size() == current_param_index) {
-    // No moves were specified, handle of command is completed.
-    return true;
-  }
-
-  if (params[current_param_index] != "moves") {
-    LogWithEndLine(Logger::LogSection::UCI_HANDLER, "position: \"moves\" expected, got \"", params[current_param_index], "\"");
-    return false;
-  }
-  ++current_param_index;
-  if (current_param_index >= params.size()) {
-    LogWithEndLine(Logger::LogSection::UCI_HANDLER, "position: keyword moves found but no moves were specified");
-    return false;
-  }
   for (unsigned index = current_param_index; index < params.size(); ++index) {
     std::string move = params[index];
     if (move.size() != 4 && move.size() != 5) {
@@ -188,13 +216,41 @@ bool UCIHandler::handleCommandPosition(const std::vector<std::string>& params) {
         return false;
       }
     }
-    try {
-      board_.makeMove(Field(old_field.c_str()), Field(new_field.c_str()), promotion);
-    } catch (const std::exception&) {
+    Figure::Move board_move(Field(old_field.c_str()), Field(new_field.c_str()), promotion);
+    if (board_.validateMove(board_move) == false) {
       LogWithEndLine(Logger::LogSection::UCI_HANDLER, "position: invalid move ", move);
       return false;
     }
+    board_.makeTrustedMove(board_move);
   }
+  last_position_params_ = params;
+  return true;
+}
+
+bool UCIHandler::handleCommandSetOption(const std::vector<std::string>& params) {
+  if (params.size() != 4 || params[0] != "name" || params[2] != "value") {
+    LogWithEndLine(Logger::LogSection::UCI_HANDLER, "setoption: expected \"name <id> value <x>\"");
+    return false;
+  }
+  if (move_calculation_in_progress_ == true) {
+    LogWithEndLine(Logger::LogSection::UCI_HANDLER, "setoption: move calculation in progress");
+    return false;
+  }
+  auto option = std::find_if(std::begin(g_spin_options), std::end(g_spin_options),
+                             [&params](const SpinOption& o) { return params[1] == o.name; });
+  if (option == std::end(g_spin_options)) {
+    LogWithEndLine(Logger::LogSection::UCI_HANDLER, "setoption: unknown option ", params[1]);
+    return false;
+  }
+  unsigned value = 0;
+  if (utils::str_2_uint(params[3], value) == false ||
+      value < static_cast<unsigned>(option->min) || value > static_cast<unsigned>(option->max)) {
+    LogWithEndLine(Logger::LogSection::UCI_HANDLER, "setoption: bad value ", params[3]);
+    return false;
+  }
+  Engine::PruningMargins margins = engine_.getPruningMargins();
+  margins.*option->value = static_cast<int>(value);
+  engine_.setPruningMargins(margins);
   return true;
 }
 
@@ -228,7 +284,8 @@ bool UCIHandler::handleCommandGo(const std::vector<std::string>& params) {
     std::thread make_move_thread(&UCIHandler::calculateMoveOnAnotherThread,
                                  this,
                                  0, /* no time limit */
-                                 1000 /* infinite depth */);
+                                 1000 /* infinite depth */,
+                                 0 /* no mate search */);
     make_move_thread.detach();
   }
   if (params[0] == "movetime") {
@@ -245,7 +302,26 @@ bool UCIHandler::handleCommandGo(const std::vector<std::string>& params) {
     std::thread make_move_thread(&UCIHandler::calculateMoveOnAnotherThread,
                                  this,
                                  time_for_move,
-                                 1000);
+                                 1000,
+                                 0);
+    make_move_thread.detach();
+  }
+  if (params[0] == "mate") {
+    if (params.size() < 2) {
+      LogWithEndLine(Logger::LogSection::UCI_HANDLER, "go: got mate without value");
+      return false;
+    }
+    unsigned moves_to_mate = 0;
+    if (utils::str_2_uint(params[1], moves_to_mate) == false || moves_to_mate == 0) {
+      LogWithEndLine(Logger::LogSection::UCI_HANDLER, "go: got mate with invalid value");
+      return false;
+    }
+    move_calculation_in_progress_ = true;
+    std::thread make_move_thread(&UCIHandler::calculateMoveOnAnotherThread,
+                                 this,
+                                 0,
+                                 1000,
+                                 moves_to_mate);
     make_move_thread.detach();
   }
   return true;
@@ -262,8 +338,9 @@ void UCIHandler::sendInfoToGUI(Engine::SearchInfo info) const {
   ostr_ <<  response.str() << std::endl;
 }
 
-void UCIHandler::calculateMoveOnAnotherThread(unsigned time_for_move, unsigned max_depth) {
-  auto info = engine_.startSearch(time_for_move, max_depth);
+void UCIHandler::calculateMoveOnAnotherThread(unsigned time_for_move, unsigned max_depth, unsigned moves_to_mate) {
+  auto info = moves_to_mate > 0 ? engine_.startMateSearch(time_for_move, moves_to_mate)
+                                : engine_.startSearch(time_for_move, max_depth);
   sendInfoToGUI(info);
   std::stringstream response;
   Figure::Move move = info.best_line[0];
@@ -32,6 +32,7 @@ class UCIHandler {
   UCIHandler(std::istream& istr, std::ostream& ostr);
   void start();
   const Board& getBoard() const { return board_; }
+  const Engine& getEngine() const { return engine_; }
 
   // public for testing purposes
   void handleCommand(const std::string& command);
@@ -42,14 +43,19 @@ class UCIHandler {
   bool handleCommandPosition(const std::vector<std::string>& params);
   bool handleCommandGo(const std::vector<std::string>& params);
   bool handleCommandStop(const std::vector<std::string>& params);
+  bool handleCommandSetOption(const std::vector<std::string>& params);
 
  private:
-  void calculateMoveOnAnotherThread(unsigned time_for_move, unsigned max_depth);
+  // Searches for a mate when moves_to_mate is not zero.
+  void calculateMoveOnAnotherThread(unsigned time_for_move, unsigned max_depth, unsigned moves_to_mate);
   void sendInfoToGUI(Engine::SearchInfo info) const;
 
   bool move_calculation_in_progress_{false};
   std::mutex move_calculation_in_progress_mutex_;
   std::condition_variable move_calculation_in_progress_cv_;
+  // Parameters of the last successful position command, the board is in
+  // the position they describe.
+  std::vector<std::string> last_position_params_;
   std::istream& istr_;
   std::ostream& ostr_;
   Board board_;
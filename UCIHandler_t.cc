@@ -104,7 +104,16 @@ class UCIHandlerWrapper {
 
     line_istream << "quit" << std::endl;
     std::unique_lock ul(uci_handler_started_mutex_);
-    uci_handler_started_cv_.wait(ul, [this] { return uci_handler_started_ == false; });
+    while (uci_handler_started_cv_.wait_for(ul, std::chrono::milliseconds(5),
+               [this] { return uci_handler_started_ == false; }) == false) {
+      // A line written before the stream was closed may still be waiting
+      // for a reader, drain it so the handler can get to the quit command.
+      ul.unlock();
+      while (line_ostream_buf.isLineReadyForRead() == true) {
+        while (line_ostream_buf.sbumpc() != '\n') {}
+      }
+      ul.lock();
+    }
 
     return response_found;
   }
@@ -116,6 +125,10 @@ class UCIHandlerWrapper {
   const Board& getBoard() const {
     return handler_.getBoard();
   }
+
+  const Engine& getEngine() const {
+    return handler_.getEngine();
+  }
   
  private:
   void uciThread() {
@@ -169,6 +182,18 @@ TEST_PROCEDURE(UCIHandlerHandlesCommandGO) {
   TEST_END
 }
 
+TEST_PROCEDURE(UCIHandlerHandlesCommandGOMate) {
+  TEST_START
+  UCIHandlerWrapper wrapper;
+  wrapper.sendCommand("position fen 8/8/1b6/1k6/3q4/3n4/6PP/R3R2K b - - 0 1");
+  VERIFY_TRUE(wrapper.sendCommandAndWaitForResponse("go mate 3", " mate 2 ", 100));
+  VERIFY_TRUE(wrapper.sendCommandAndWaitForResponse("go mate 3", "bestmove d4g1", 100));
+  wrapper.sendCommand("position fen 6q1/2k5/8/8/8/8/5K2/Q7 w - - 0 1");
+  wrapper.sendCommand("go mate 20");
+  VERIFY_TRUE(wrapper.sendCommandAndWaitForResponse("stop", "bestmove ", 100));
+  TEST_END
+}
+
 TEST_PROCEDURE(UCIHandlerHandlesCommandSTOP) {
   TEST_START
   UCIHandlerWrapper wrapper;
@@ -177,6 +202,44 @@ TEST_PROCEDURE(UCIHandlerHandlesCommandSTOP) {
   TEST_END
 }
 
+TEST_PROCEDURE(UCIHandlerHandlesCommandSETOPTION) {
+  TEST_START
+  UCIHandlerWrapper wrapper;
+  const Engine& engine = wrapper.getEngine();
+  const Engine::PruningMargins defaults;
+  VERIFY_TRUE(wrapper.sendCommandAndWaitForResponse("uci", "option name FutilityMargin type spin", 100));
+  VERIFY_TRUE(wrapper.sendCommandAndWaitForResponse("uci", "option name RazoringMargin type spin", 100));
+  wrapper.sendCommand("setoption name FutilityMargin value 0");
+  VERIFY_EQUALS(engine.getPruningMargins().futility, 0);
+  wrapper.sendCommand("setoption  name RazoringMargin value 2000 ");
+  VERIFY_EQUALS(engine.getPruningMargins().razoring, 2000);
+  VERIFY_EQUALS(engine.getPruningMargins().reverse_futility, defaults.reverse_futility);
+
+  const char* bad_commands[] = {
+    "setoption name RazoringMargin value 2001",
+    "setoption name ReverseFutilityMargin value -1",
+    "setoption name ReverseFutilityMargin value 1x",
+    "setoption name Hash value 16",
+    "setoption name FutilityMargin 10",
+    "setoption FutilityMargin value 10",
+    "setoption name FutilityMargin value"
+  };
+  for (const char* command: bad_commands) {
+    bool failed = false;
+    try {
+      wrapper.sendCommand(command);
+    } catch (const UCIHandler::HandleOfCommandFailed&) {
+      failed = true;
+    }
+    VERIFY_TRUE(failed);
+  }
+  VERIFY_EQUALS(engine.getPruningMargins().futility, 0);
+  VERIFY_EQUALS(engine.getPruningMargins().reverse_futility, defaults.reverse_futility);
+  VERIFY_EQUALS(engine.getPruningMargins().razoring, 2000);
+  VERIFY_TRUE(wrapper.sendCommandAndWaitForResponse("go movetime 100", "bestmove ", 150));
+  TEST_END
+}
+
 TEST_PROCEDURE(UCIHandlerHandlesCommandPOSITION) {
   TEST_START
   UCIHandlerWrapper wrapper;
@@ -187,6 +250,10 @@ TEST_PROCEDURE(UCIHandlerHandlesCommandPOSITION) {
   VERIFY_STRINGS_EQUAL(board.createFEN().c_str(), "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
   wrapper.sendCommand("position startpos moves d2d4 d7d5");
   VERIFY_STRINGS_EQUAL(board.createFEN().c_str(), "rnbqkbnr/ppp1pppp/8/3p4/3P4/8/PPP1PPPP/RNBQKBNR w KQkq d6 0 2");
+  wrapper.sendCommand("position  startpos moves d2d4 d7d5 c2c4 ");
+  VERIFY_STRINGS_EQUAL(board.createFEN().c_str(), "rnbqkbnr/ppp1pppp/8/3p4/2PP4/8/PP2PPPP/RNBQKBNR b KQkq c3 0 2");
+  wrapper.sendCommand("position startpos moves e2e4");
+  VERIFY_STRINGS_EQUAL(board.createFEN().c_str(), "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1");
   TEST_END
 }
 